@@ -0,0 +1,142 @@
+#include "Batch.h"
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Notation.h"
+
+namespace {
+	constexpr std::size_t ROW_BYTES = sizeof(Puzzle::Row);
+	static_assert(ROW_BYTES == 16);
+
+	void writeRow(std::ostream &out, const Puzzle::Row row) {
+		out.write(reinterpret_cast<const char *>(&row), ROW_BYTES);
+	}
+}
+
+BatchFile::BatchFile(const std::string &path) {
+	const int descriptor = ::open(path.c_str(), O_RDONLY);
+	if (descriptor < 0) {
+		throw std::runtime_error("Cannot open batch file: " + path);
+	}
+	struct stat info{};
+	if (::fstat(descriptor, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(BatchHeader)) {
+		::close(descriptor);
+		throw std::runtime_error("Not a batch file: " + path);
+	}
+	length = static_cast<std::size_t>(info.st_size);
+	mapping = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+	// The mapping keeps the file open by itself
+	::close(descriptor);
+	if (mapping == MAP_FAILED) {
+		mapping = nullptr;
+		throw std::runtime_error("Cannot map batch file: " + path);
+	}
+	// Workers each read their own range once, front to back
+	::madvise(mapping, length, MADV_SEQUENTIAL);
+
+	BatchHeader header{};
+	std::memcpy(&header, mapping, sizeof(header));
+	stride = (header.flags & HAS_TARGETS) != 0 ? 4 : 2;
+	count = header.count;
+	records = static_cast<const unsigned char *>(mapping) + sizeof(BatchHeader);
+	if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+	    (length - sizeof(BatchHeader)) / (stride * ROW_BYTES) < count) {
+		::munmap(mapping, length);
+		mapping = nullptr;
+		throw std::runtime_error("Not a whole batch file: " + path);
+	}
+}
+
+BatchFile::~BatchFile() {
+	if (mapping != nullptr) {
+		::munmap(mapping, length);
+	}
+}
+
+std::size_t BatchFile::size() const {
+	return count;
+}
+
+bool BatchFile::hasTargets() const {
+	return stride == 4;
+}
+
+Puzzle::Row BatchFile::row(const std::size_t index, const std::size_t offset) const {
+	Puzzle::Row row;
+	std::memcpy(&row, records + (index * stride + offset) * ROW_BYTES, ROW_BYTES);
+	return row;
+}
+
+Puzzle BatchFile::state(const std::size_t index) const {
+	return {row(index, 0), row(index, 1)};
+}
+
+std::pair<Puzzle::Row, Puzzle::Row> BatchFile::targetMask(const std::size_t index) const {
+	if (!hasTargets()) {
+		return {0, 0};
+	}
+	return {row(index, 2), row(index, 3)};
+}
+
+std::size_t convertBatch(std::istream &in, const std::string &path) {
+	struct Record {
+		Puzzle state;
+		Puzzle::Row topMask;
+		Puzzle::Row bottomMask;
+	};
+
+	std::vector<Record> records;
+	bool targets = false;
+	std::string line;
+	for (std::size_t number = 1; std::getline(in, line); ++number) {
+		if (line.find_first_not_of(" \t\r") == std::string::npos) {
+			continue;
+		}
+		const std::size_t tab = line.find('\t');
+		std::string target = tab != std::string::npos ? line.substr(tab + 1) : "";
+		if (!target.empty() && target.back() == '\r') {
+			target.pop_back();
+		}
+
+		try {
+			Record record{parsePuzzle(line.substr(0, tab)), 0, 0};
+			if (target == "solved") {
+				record.topMask = Puzzle::ROW_MASK;
+				record.bottomMask = Puzzle::ROW_MASK;
+			} else if (!target.empty() && target != "separated") {
+				std::tie(record.topMask, record.bottomMask) = parseRows(target);
+			}
+			targets |= !target.empty();
+			records.push_back(record);
+		} catch (const std::logic_error &e) {
+			throw std::invalid_argument("Line " + std::to_string(number) + ": " + e.what());
+		}
+	}
+
+	std::ofstream out(path, std::ios::binary);
+	BatchHeader header{};
+	std::memcpy(header.magic, BatchFile::MAGIC, sizeof(header.magic));
+	header.version = BatchFile::VERSION;
+	header.flags = targets ? BatchFile::HAS_TARGETS : 0;
+	header.count = records.size();
+	out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+	for (const Record &record: records) {
+		writeRow(out, record.state.getTop());
+		writeRow(out, record.state.getBottom());
+		if (targets) {
+			writeRow(out, record.topMask);
+			writeRow(out, record.bottomMask);
+		}
+	}
+	if (!out) {
+		throw std::runtime_error("Cannot write batch file: " + path);
+	}
+	return records.size();
+}
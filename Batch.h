@@ -0,0 +1,105 @@
+#ifndef BATCH_H
+#define BATCH_H
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <utility>
+#include "Puzzle.h"
+
+/**
+ * @file Batch.h
+ *
+ * @brief A binary file of states to solve in bulk, read straight out of a memory mapping.
+ *
+ * Parsing millions of scrambles costs more than solving the easy ones, so a batch is converted from notation once
+ * (See convertBatch()) and then mapped into memory, where every worker reads its own range of records in place.
+ *
+ * Layout, in native byte order:
+ *
+ *   Header:  32 bytes. See BatchHeader
+ *   Records: `count` records of two 16-byte rows, top then bottom, each encoded exactly as a Puzzle::Row.
+ *            With HAS_TARGETS, every record is followed by a top and bottom target mask, also 16 bytes each.
+ *            See Solver::setTargetMask()
+ *
+ * Every record is a multiple of 16 bytes after a 32-byte header, so the rows stay aligned in the mapping.
+ *
+ * ──────────────────────────────────────────────────────────────────────────────────────────────────
+ */
+
+struct BatchHeader {
+	// BATCH_MAGIC, to reject anything else early
+	char magic[8];
+	uint32_t version;
+	// BatchFile::HAS_TARGETS, or 0
+	uint32_t flags;
+	// The number of records
+	uint64_t count;
+	uint64_t reserved;
+};
+
+static_assert(sizeof(BatchHeader) == 32);
+
+/**
+ * @class BatchFile
+ *
+ * @brief A read only memory mapping of a batch file.
+ */
+class BatchFile {
+public:
+	static constexpr char MAGIC[8] = {'H', 'E', 'X', '1', 'B', 'A', 'T', 'C'};
+	static constexpr uint32_t VERSION = 1;
+	// Each record carries target masks
+	static constexpr uint32_t HAS_TARGETS = 1;
+
+	/**
+	 * @brief Maps a batch file into memory.
+	 *
+	 * @throws runtime_error If the file cannot be mapped, or is not a whole batch file.
+	 */
+	explicit BatchFile(const std::string &path);
+
+	~BatchFile();
+
+	BatchFile(const BatchFile &) = delete;
+
+	BatchFile &operator=(const BatchFile &) = delete;
+
+	[[nodiscard]] std::size_t size() const;
+
+	[[nodiscard]] bool hasTargets() const;
+
+	/**
+	 * @brief The state of a record, read in place.
+	 */
+	[[nodiscard]] Puzzle state(std::size_t index) const;
+
+	/**
+	 * @brief The target masks of a record, top then bottom, or zero masks if the batch has none.
+	 */
+	[[nodiscard]] std::pair<Puzzle::Row, Puzzle::Row> targetMask(std::size_t index) const;
+
+private:
+	void *mapping = nullptr;
+	std::size_t length = 0;
+	std::size_t count = 0;
+	// The number of rows in each record
+	std::size_t stride = 0;
+	const unsigned char *records = nullptr;
+
+	[[nodiscard]] Puzzle::Row row(std::size_t index, std::size_t offset) const;
+};
+
+/**
+ * @brief Converts states in notation into a batch file, one per line. See Notation.h
+ *
+ * A line may give a target after a tab: `solved`, `separated`, or both masks in the hexadecimal state format.
+ * If any line does, every record carries target masks, and those without one are only separated.
+ * Blank lines are skipped.
+ *
+ * @return The number of records written.
+ * @throws invalid_argument If a line cannot be parsed or its state reached, naming its line number.
+ * @throws runtime_error If the file cannot be written.
+ */
+std::size_t convertBatch(std::istream &in, const std::string &path);
+
+#endif //BATCH_H
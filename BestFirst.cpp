@@ -0,0 +1,283 @@
+#include "BestFirst.h"
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <string>
+
+BestFirst::BestFirst(const int limit, const MoveSet moveSet, const Goal goal, const std::size_t maxNodes)
+	: limit(limit), moveSet(moveSet), goal(goal), maxNodes(maxNodes), shapes(ShapeTable::instance()),
+	  layers(goal == Goal::SEPARATED || goal == Goal::MATCHED ? nullptr : &LayerTable::instance()),
+	  goalBits(goal == Goal::SEPARATED || goal == Goal::MATCHED ? Solver<>::SEPARATED_BITS : Puzzle::ROW_MASK) {
+	if (limit < 0 || limit > Solver<>::MAX_DEPTH) {
+		throw std::invalid_argument("The limit must be within [0, " + std::to_string(Solver<>::MAX_DEPTH) + "].");
+	}
+	if (maxNodes < 2 || maxNodes > NONE) {
+		throw std::invalid_argument("The node limit must be within [2, " + std::to_string(NONE) + "].");
+	}
+}
+
+void BestFirst::setTargetMask(const Puzzle::Row topMask, const Puzzle::Row bottomMask) {
+	this->topMask = topMask;
+	this->bottomMask = bottomMask;
+	goalBits = goal == Goal::MATCHED ? Solver<>::SEPARATED_BITS | topMask | bottomMask : goalBits;
+}
+
+bool BestFirst::reached(const Puzzle &puzzle) const {
+	switch (goal) {
+		case Goal::SEPARATED:
+			return puzzle.cubeShape() && puzzle.isRowOrientationSolved();
+		case Goal::SOLVED:
+			return puzzle.isSolved();
+		case Goal::TOP_LAYER:
+			return puzzle.isTopSolved();
+		case Goal::BOTTOM_LAYER:
+			return puzzle.isBottomSolved();
+		case Goal::MATCHED:
+			return puzzle.isSolvedByMatches(Puzzle::SOLVED_TOP, topMask, Puzzle::SOLVED_BOTTOM, bottomMask);
+	}
+	return false;
+}
+
+int BestFirst::estimate(const Puzzle &puzzle, const RowShape topShape, const RowShape bottomShape) const {
+	int bound = Bounds::slicesToSeparate(puzzle);
+	if (goal == Goal::SEPARATED || goal == Goal::SOLVED || goal == Goal::MATCHED) {
+		bound = std::max<int>(bound, shapes.distance(topShape, bottomShape));
+	}
+	// Past its radius, the layer table can't raise the bound. Unlike Solver, every node is worth the lookup
+	if (layers == nullptr || bound > LayerTable::RADIUS) {
+		return bound;
+	}
+	if (goal != Goal::BOTTOM_LAYER) {
+		bound = std::max<int>(bound, layers->topDistance(puzzle));
+	}
+	if (goal != Goal::TOP_LAYER) {
+		bound = std::max<int>(bound, layers->bottomDistance(puzzle));
+	}
+	return bound;
+}
+
+void BestFirst::push(const uint32_t index) {
+	Node &node = arena[index];
+	node.open = true;
+	leaves[node.f].push_back(index);
+}
+
+uint32_t BestFirst::allocate(const Node &node, const uint32_t expanding, const int floor) {
+	if (freeSlots.empty() && arena.size() >= maxNodes && !forgetWorst(expanding, floor)) {
+		return NONE;
+	}
+	if (freeSlots.empty()) {
+		arena.push_back(node);
+		return static_cast<uint32_t>(arena.size() - 1);
+	}
+	const uint32_t index = freeSlots.back();
+	freeSlots.pop_back();
+	arena[index] = node;
+	return index;
+}
+
+void BestFirst::release(uint32_t index) {
+	while (index != 0) {
+		Node &node = arena[index];
+		if (!node.turnOnly) {
+			const auto found = seen.find(state(index));
+			if (found != seen.end() && found->second == index) {
+				seen.erase(found);
+			}
+		}
+		node.open = false;
+		freeSlots.push_back(index);
+
+		index = node.parent;
+		Node &parent = arena[index];
+		--parent.children;
+		// A parent still waiting to be expanded, or with other children, is still needed
+		if (parent.open || parent.children != 0) {
+			return;
+		}
+	}
+}
+
+bool BestFirst::forgetWorst(const uint32_t expanding, const int floor) {
+	if (turnover >= MAX_TURNOVER * maxNodes) {
+		return false;
+	}
+	// A reopened parent becomes a leaf again once its children have all been forgotten, but most still have some,
+	// so those are only looked through once there is nothing else to forget
+	for (std::vector<std::deque<uint32_t> > *list: {&leaves, &reopened}) {
+		for (int f = limit; f >= floor; --f) {
+			std::deque<uint32_t> &bucket = (*list)[f];
+			// The oldest entries, at the front, are the shallowest
+			for (std::size_t i = 0; i < bucket.size();) {
+				const uint32_t index = bucket[i];
+				const Node &node = arena[index];
+				// Left behind by a node since expanded, moved, or freed, whose slot may now hold a reopened parent
+				if (!node.open || node.f != f || (list == &leaves && node.children != 0)) {
+					bucket.erase(bucket.begin() + static_cast<std::ptrdiff_t>(i));
+					continue;
+				}
+				// At the same f, forgetting a child of the node being expanded would only reopen it to regenerate the child
+				if (node.children != 0 || index == 0 || (f == floor && node.parent == expanding)) {
+					++i;
+					continue;
+				}
+				bucket.erase(bucket.begin() + static_cast<std::ptrdiff_t>(i));
+
+				// The parent takes the child's place on the open list, at the lowest f it has lost
+				const uint32_t parentIndex = node.parent;
+				Node &parent = arena[parentIndex];
+				parent.forgotten = std::min(parent.forgotten, node.f);
+				if (!parent.open || parent.f > parent.forgotten) {
+					parent.f = parent.forgotten;
+					parent.open = true;
+					reopened[parent.f].push_back(parentIndex);
+				}
+				release(index);
+				++turnover;
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+bool BestFirst::expand(const uint32_t index) {
+	const Puzzle puzzle = state(index);
+	const int depth = arena[index].depth;
+	// The node's f may rise while it is expanded, if one of its children is forgotten
+	const int floor = arena[index].f;
+	const RowShape topShape = ShapeTable::shapeOf(puzzle.getTop());
+	const RowShape bottomShape = ShapeTable::shapeOf(puzzle.getBottom());
+	arena[index].open = false;
+	arena[index].forgotten = UNKNOWN;
+	++expansions;
+
+	// Holds the node being expanded, so that none of its children can free it
+	++arena[index].children;
+	const uint32_t bottoms = ShapeTable::sliceableTurns(bottomShape) & moveSet.turns;
+	for (uint32_t tops = ShapeTable::sliceableTurns(topShape) & moveSet.turns; tops != 0; tops &= tops - 1) {
+		for (uint32_t turns = bottoms; turns != 0; turns &= turns - 1) {
+			const Move move{static_cast<uint8_t>(std::countr_zero(tops)), static_cast<uint8_t>(std::countr_zero(turns))};
+			Puzzle next = puzzle.clone();
+			next.turn(move.top, move.bottom);
+
+			// A goal one turn away ends the solution on that turn
+			if (depth < limit && reached(next)) {
+				const uint32_t goalIndex = allocate({
+					next.getTop(), next.getBottom(), index, move, static_cast<uint8_t>(depth + 1),
+					static_cast<uint8_t>(depth + 1), UNKNOWN, 0, false, true
+				}, index, floor);
+				if (goalIndex == NONE) {
+					return false;
+				}
+				++arena[index].children;
+				push(goalIndex);
+			}
+
+			next.slice();
+			RowShape nextTop = ShapeTable::turn(topShape, move.top);
+			RowShape nextBottom = ShapeTable::turn(bottomShape, move.bottom);
+			ShapeTable::slice(nextTop, nextBottom);
+			const int f = depth + 1 + estimate(next, nextTop, nextBottom);
+			if (f > limit) {
+				continue;
+			}
+
+			const auto found = seen.find(next);
+			if (found != seen.end()) {
+				Node &held = arena[found->second];
+				// Expanded nodes, reopened or not, already have their shortest path, by the order of the open list
+				if (!held.open || held.children != 0 || held.depth <= depth + 1) {
+					continue;
+				}
+				const uint32_t oldParent = held.parent;
+				held.parent = index;
+				held.move = move;
+				held.depth = static_cast<uint8_t>(depth + 1);
+				held.f = static_cast<uint8_t>(f);
+				++arena[index].children;
+				push(found->second);
+				if (--arena[oldParent].children == 0 && !arena[oldParent].open) {
+					release(oldParent);
+				}
+				continue;
+			}
+
+			const uint32_t child = allocate({
+				next.getTop(), next.getBottom(), index, move, static_cast<uint8_t>(depth + 1), static_cast<uint8_t>(f),
+				UNKNOWN, 0, false, false
+			}, index, floor);
+			if (child == NONE) {
+				return false;
+			}
+			seen.emplace(next, child);
+			++arena[index].children;
+			push(child);
+		}
+	}
+
+	if (--arena[index].children == 0 && !arena[index].open) {
+		release(index);
+	}
+	return true;
+}
+
+BestFirst::Result BestFirst::path(uint32_t index) const {
+	Result result;
+	result.endsOnSlice = !arena[index].turnOnly;
+	for (; index != 0; index = arena[index].parent) {
+		result.moves.push_back(arena[index].move);
+	}
+	std::ranges::reverse(result.moves);
+	return result;
+}
+
+std::optional<BestFirst::Result> BestFirst::solve(const Puzzle &start, const std::atomic<bool> &cancelled) {
+	arena.clear();
+	freeSlots.clear();
+	seen.clear();
+	leaves.assign(limit + 1, {});
+	reopened.assign(limit + 1, {});
+	expansions = 0;
+	turnover = 0;
+
+	const Puzzle root(start.getTop() & goalBits, start.getBottom() & goalBits);
+	if (reached(root)) {
+		return Result{};
+	}
+	const int f = estimate(root, ShapeTable::shapeOf(root.getTop()), ShapeTable::shapeOf(root.getBottom()));
+	if (f > limit) {
+		return std::nullopt;
+	}
+	arena.push_back({root.getTop(), root.getBottom(), NONE, {}, 0, static_cast<uint8_t>(f), UNKNOWN, 0, false, false});
+	seen.emplace(root, 0);
+	push(0);
+
+	for (int bucket = f; bucket <= limit;) {
+		// New nodes first, so that a reopened parent doesn't regenerate a child forgotten for them straight away
+		std::deque<uint32_t> &entries = !leaves[bucket].empty() ? leaves[bucket] : reopened[bucket];
+		if (entries.empty()) {
+			++bucket;
+			turnover = 0;
+			continue;
+		}
+		const uint32_t index = entries.back();
+		entries.pop_back();
+		const Node &node = arena[index];
+		// Entries left behind by nodes since expanded, moved to a lower f, or forgotten
+		if (!node.open || node.f != bucket) {
+			continue;
+		}
+		if (node.turnOnly || (index != 0 && reached(state(index)))) {
+			return path(index);
+		}
+		if (expansions % CANCEL_CHECK_INTERVAL == 0 && cancelled.load(std::memory_order_relaxed)) {
+			return std::nullopt;
+		}
+		// Every child is at least as far as its parent, so no bucket below this one is filled again
+		if (!expand(index)) {
+			return std::nullopt;
+		}
+	}
+	return std::nullopt;
+}
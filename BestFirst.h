@@ -0,0 +1,173 @@
+#ifndef BEST_FIRST_H
+#define BEST_FIRST_H
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include "Bounds.h"
+#include "Layer.h"
+#include "Move.h"
+#include "Puzzle.h"
+#include "Shape.h"
+#include "Solver.h"
+
+/**
+ * @class BestFirst
+ *
+ * @brief A* search within a memory cap, expanding the node with the fewest moves so far plus moves left first.
+ *
+ * Unlike Solver, which searches every depth again from the start, each node is expanded once, so states reached
+ * by many paths cost nothing extra. The moves left are bounded by the same tables (See Solver::prune()).
+ *
+ * Every f value is a small integer, so the open list is a bucket queue: a stack of new nodes per f value, popped from
+ * the lowest, and deepest first within it. Nodes are packed records in an arena reused between solves, linked to
+ * their parent by index, and a hash map from state to node catches states reached again.
+ *
+ * When the arena is full, the open nodes with the highest f are forgotten, as in SMA*. Their parent remembers the
+ * lowest f it lost and goes back on the open list at that value, behind the new nodes there, to regenerate them if
+ * they turn out to be needed.
+ * Nodes with a lower f than the one being expanded are never forgotten, nor are its own children at the same f.
+ * A search gives up once they alone fill the arena, or once it has forgotten the arena several times over without
+ * the lowest f rising (See MAX_TURNOVER), which means the forgotten subtrees are being searched again in turn.
+ * A node whose children all turned out to be dead ends is freed straight away.
+ *
+ * An instance isn't thread safe. Use one per thread, so that each has its own arena.
+ */
+class BestFirst {
+public:
+	struct Result {
+		std::vector<Move> moves;
+		// Whether the last move includes its slice
+		bool endsOnSlice = true;
+	};
+
+	// The most nodes held at once before the worst are forgotten
+	static constexpr std::size_t DEFAULT_MAX_NODES = 1 << 21;
+
+	/**
+	 * @param limit The most moves in a solution, up to Solver::MAX_DEPTH.
+	 * @param moveSet The turn amounts tried for each row.
+	 * @param goal The states counted as solutions.
+	 * @param maxNodes The most nodes held at once.
+	 *
+	 * @throws invalid_argument If the limit is out of range or maxNodes is too small to hold the start and a child.
+	 */
+	BestFirst(int limit, MoveSet moveSet, Goal goal, std::size_t maxNodes = DEFAULT_MAX_NODES);
+
+	/**
+	 * @brief Sets which bits of each row Goal::MATCHED compares against the solved state. See Solver::setTargetMask()
+	 */
+	void setTargetMask(Puzzle::Row topMask, Puzzle::Row bottomMask);
+
+	/**
+	 * @brief Finds a shortest solution, unless the limit is reached, memory runs out, or the search is cancelled.
+	 */
+	[[nodiscard]] std::optional<Result> solve(const Puzzle &start, const std::atomic<bool> &cancelled);
+
+	/**
+	 * @brief The nodes expanded by the last solve, counting re-expansions of a parent whose children were forgotten.
+	 */
+	[[nodiscard]] std::size_t expanded() const {
+		return expansions;
+	}
+
+private:
+	using RowShape = ShapeTable::RowShape;
+
+	static constexpr uint32_t NONE = UINT32_MAX;
+	static constexpr uint8_t UNKNOWN = UINT8_MAX;
+	// The nodes expanded between checks for cancellation
+	static constexpr std::size_t CANCEL_CHECK_INTERVAL = 1 << 10;
+	// The most nodes forgotten at one f, as a multiple of maxNodes, before the search is taken to be regenerating
+	// what it forgot in a cycle, and gives up
+	static constexpr std::size_t MAX_TURNOVER = 4;
+
+	struct Node {
+		Puzzle::Row top;
+		Puzzle::Row bottom;
+		uint32_t parent;
+		// The move from the parent
+		Move move;
+		uint8_t depth;
+		uint8_t f;
+		// The lowest f of a forgotten child, or UNKNOWN if none was
+		uint8_t forgotten;
+		// The children still held, which keep a node from being forgotten itself
+		uint16_t children;
+		// Whether the node is on the open list
+		bool open;
+		// Whether the move stopped after its turn, which only a solution can
+		bool turnOnly;
+	};
+
+	int limit;
+	MoveSet moveSet;
+	Goal goal;
+	std::size_t maxNodes;
+	Puzzle::Row topMask = 0;
+	Puzzle::Row bottomMask = 0;
+	const ShapeTable &shapes;
+	const LayerTable *layers;
+	// The bits of each slot the goal reads, so that states differing elsewhere share a node. See Solver::SEPARATED_BITS
+	Puzzle::Row goalBits;
+
+	std::vector<Node> arena;
+	std::vector<uint32_t> freeSlots;
+	// The open list, by f: nodes not yet expanded, and nodes reopened when a child was forgotten
+	std::vector<std::deque<uint32_t> > leaves;
+	std::vector<std::deque<uint32_t> > reopened;
+	std::unordered_map<Puzzle, uint32_t, PuzzleHash> seen;
+	std::size_t expansions = 0;
+	// The nodes forgotten since the lowest f on the open list last rose
+	std::size_t turnover = 0;
+
+	[[nodiscard]] bool reached(const Puzzle &puzzle) const;
+
+	/**
+	 * @brief A lower bound on the moves left, which may exceed any limit. See Solver::prune(), Bounds
+	 */
+	[[nodiscard]] int estimate(const Puzzle &puzzle, RowShape topShape, RowShape bottomShape) const;
+
+	/**
+	 * @brief Stores a node, forgetting the worst open nodes first if the arena is full.
+	 *
+	 * @param expanding The node being expanded, which limits what may be forgotten. See forgetWorst()
+	 * @param floor Its f when it was taken off the open list.
+	 * @return Its index, or NONE if nothing could be forgotten.
+	 */
+	uint32_t allocate(const Node &node, uint32_t expanding, int floor);
+
+	/**
+	 * @brief Forgets a node not yet expanded with the highest f, the shallowest first, reopening its parent.
+	 *
+	 * Nothing below the floor may be forgotten, nor the children of the node being expanded at the floor itself.
+	 */
+	bool forgetWorst(uint32_t expanding, int floor);
+
+	/**
+	 * @brief Frees a node without open children, and then its parent if that leaves it a dead end too.
+	 */
+	void release(uint32_t index);
+
+	void push(uint32_t index);
+
+	/**
+	 * @brief Generates a node's children, skipping states already held as near the start.
+	 *
+	 * @return FALSE if memory ran out.
+	 */
+	bool expand(uint32_t index);
+
+	/**
+	 * @brief The state of a node, rebuilt from its rows.
+	 */
+	[[nodiscard]] Puzzle state(uint32_t index) const {
+		return {arena[index].top, arena[index].bottom};
+	}
+
+	[[nodiscard]] Result path(uint32_t index) const;
+};
+
+#endif //BEST_FIRST_H
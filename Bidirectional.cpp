@@ -0,0 +1,144 @@
+#include "Bidirectional.h"
+#include <algorithm>
+#include <bit>
+#include "Shape.h"
+
+Bidirectional::Bidirectional(const int limit, const MoveSet moveSet, const std::size_t maxStates) : limit(limit),
+	moveSet(moveSet), maxStates(maxStates) {
+}
+
+Bidirectional::Result Bidirectional::join(const Side &forward, const Side &backward, const Puzzle &meeting,
+                                          const Puzzle &start) {
+	Result result;
+	for (Puzzle state = meeting; !(state == start);) {
+		const Link &link = forward.at(state);
+		result.moves.push_back(link.move);
+		state = link.towards;
+	}
+	std::reverse(result.moves.begin(), result.moves.end());
+
+	const Puzzle solved;
+	for (Puzzle state = meeting; !(state == solved);) {
+		const Link &link = backward.at(state);
+		result.moves.push_back(link.move);
+		result.endsOnSlice = !link.turnOnly;
+		state = link.towards;
+	}
+	return result;
+}
+
+std::optional<Bidirectional::Result> Bidirectional::solve(const Puzzle &start,
+                                                          const std::atomic<bool> &cancelled) const {
+	const Puzzle solved;
+	Side forward = {{start, {start, {}, false}}};
+	Side backward = {{solved, {solved, {}, false}}};
+	if (start == solved) {
+		return Result{};
+	}
+
+	// A solution may end on a turn, so every turn away from the solved state is one move behind it.
+	// They are kept from the start so that the forward side can finish on a turn, and join the first backward layer.
+	std::vector<Puzzle> turnedAway;
+	for (uint32_t tops = moveSet.turns; tops != 0; tops &= tops - 1) {
+		for (uint32_t bottoms = moveSet.turns; bottoms != 0; bottoms &= bottoms - 1) {
+			const Move move{static_cast<uint8_t>(std::countr_zero(tops)), static_cast<uint8_t>(std::countr_zero(bottoms))};
+			Puzzle previous = solved.clone();
+			previous.turn(-move.top, -move.bottom);
+			if (backward.try_emplace(previous, Link{solved, move, true}).second) {
+				turnedAway.push_back(previous);
+			}
+		}
+	}
+	// Every other join is within the limit, by the loop below, but a turn away from the solved state is a layer deeper
+	// than the backward side has grown to
+	const auto joinWithinLimit = [&](const Puzzle &meeting) -> std::optional<Result> {
+		Result result = join(forward, backward, meeting, start);
+		if (static_cast<int>(result.moves.size()) > limit) {
+			return std::nullopt;
+		}
+		return result;
+	};
+	if (backward.contains(start)) {
+		return joinWithinLimit(start);
+	}
+
+	std::vector<Puzzle> forwardFrontier = {start};
+	std::vector<Puzzle> backwardFrontier = {solved};
+	int forwardDepth = 0;
+	int backwardDepth = 0;
+
+	while (forwardDepth + backwardDepth < limit) {
+		const bool growForward = !forwardFrontier.empty() &&
+		                         (backwardFrontier.empty() || forwardFrontier.size() <= backwardFrontier.size());
+		std::vector<Puzzle> next;
+
+		if (growForward) {
+			++forwardDepth;
+			for (const Puzzle &state: forwardFrontier) {
+				if (cancelled.load(std::memory_order_relaxed)) {
+					return std::nullopt;
+				}
+				const uint32_t tops = ShapeTable::sliceableTurns(ShapeTable::shapeOf(state.getTop())) & moveSet.turns;
+				const uint32_t bottoms = ShapeTable::sliceableTurns(ShapeTable::shapeOf(state.getBottom())) & moveSet.turns;
+				for (uint32_t t = tops; t != 0; t &= t - 1) {
+					for (uint32_t b = bottoms; b != 0; b &= b - 1) {
+						const Move move{static_cast<uint8_t>(std::countr_zero(t)), static_cast<uint8_t>(std::countr_zero(b))};
+						Puzzle after = state.clone();
+						after.turn(move.top, move.bottom);
+						after.slice();
+						if (!forward.try_emplace(after, Link{state, move, false}).second) {
+							continue;
+						}
+						if (backward.contains(after)) {
+							if (std::optional<Result> result = joinWithinLimit(after)) {
+								return result;
+							}
+						}
+						next.push_back(after);
+					}
+				}
+			}
+			forwardFrontier = std::move(next);
+		} else {
+			++backwardDepth;
+			for (const Puzzle &state: backwardFrontier) {
+				if (cancelled.load(std::memory_order_relaxed)) {
+					return std::nullopt;
+				}
+				if (!state.canSlice()) {
+					continue;
+				}
+
+				// The states before it are every turn back from its slice
+				Puzzle sliced = state.clone();
+				sliced.slice();
+				for (uint32_t t = moveSet.turns; t != 0; t &= t - 1) {
+					for (uint32_t b = moveSet.turns; b != 0; b &= b - 1) {
+						const Move move{static_cast<uint8_t>(std::countr_zero(t)), static_cast<uint8_t>(std::countr_zero(b))};
+						Puzzle before = sliced.clone();
+						before.turn(-move.top, -move.bottom);
+
+						if (!backward.try_emplace(before, Link{state, move, false}).second) {
+							continue;
+						}
+						if (forward.contains(before)) {
+							return join(forward, backward, before, start);
+						}
+						next.push_back(before);
+					}
+				}
+			}
+
+			if (backwardDepth == 1) {
+				next.insert(next.end(), turnedAway.begin(), turnedAway.end());
+			}
+			backwardFrontier = std::move(next);
+		}
+
+		if (forward.size() + backward.size() > maxStates ||
+		    (forwardFrontier.empty() && backwardFrontier.empty())) {
+			return std::nullopt;
+		}
+	}
+	return std::nullopt;
+}
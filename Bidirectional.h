@@ -0,0 +1,67 @@
+#ifndef BIDIRECTIONAL_H
+#define BIDIRECTIONAL_H
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include "Move.h"
+#include "Puzzle.h"
+
+/**
+ * @class Bidirectional
+ *
+ * @brief Breadth first search from the start and backwards from the solved state at once, until the two meet.
+ *
+ * Each side keeps every state it has reached, with the move that links it towards its own root, and the side with the
+ * smaller frontier grows by one layer at a time. A state found by both sides joins a path from the start to one
+ * from the solved state, so about half the depth is searched from each end, at the cost of memory.
+ *
+ * Only reaching exactly the solved state is supported (See Goal::SOLVED), since separating the faces has far too many
+ * goal states to search backwards from. Layers grow in turn, so the first meeting is within one move of optimal.
+ */
+class Bidirectional {
+public:
+	struct Result {
+		std::vector<Move> moves;
+		// Whether the last move includes its slice
+		bool endsOnSlice = true;
+	};
+
+	// The most states kept by both sides together before giving up
+	static constexpr std::size_t DEFAULT_MAX_STATES = 1 << 23;
+
+	/**
+	 * @param limit The most moves in a solution.
+	 * @param moveSet The turn amounts tried for each row.
+	 * @param maxStates The most states kept by both sides together before giving up.
+	 */
+	Bidirectional(int limit, MoveSet moveSet, std::size_t maxStates = DEFAULT_MAX_STATES);
+
+	/**
+	 * @brief Searches until the sides meet, the limit or the state budget is reached, or the search is cancelled.
+	 *
+	 * @param cancelled Checked between states, to stop early.
+	 */
+	[[nodiscard]] std::optional<Result> solve(const Puzzle &start, const std::atomic<bool> &cancelled) const;
+
+private:
+	struct Link {
+		// The state one move nearer to this side's root
+		Puzzle towards;
+		// The move between this state and `towards`, in the direction from the start to the solved state
+		Move move;
+		// Whether the move ends on its turn, which only the last move of a solution can
+		bool turnOnly;
+	};
+
+	using Side = std::unordered_map<Puzzle, Link, PuzzleHash>;
+
+	int limit;
+	MoveSet moveSet;
+	std::size_t maxStates;
+
+	static Result join(const Side &forward, const Side &backward, const Puzzle &meeting, const Puzzle &start);
+};
+
+#endif //BIDIRECTIONAL_H
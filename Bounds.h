@@ -0,0 +1,111 @@
+#ifndef BOUNDS_H
+#define BOUNDS_H
+#include <bit>
+#include <cstdint>
+#include "Puzzle.h"
+
+/**
+ * @class Bounds
+ *
+ * @brief Lower bounds on the moves to a goal, computed from the bits of a state alone, with no table.
+ *
+ * Every goal needs both faces apart: Goal::SEPARATED by definition, and a solved layer holds only its own face,
+ * which leaves the other row holding only the other face. Only a slice moves pieces between the rows, and each one
+ * swaps exactly one run of 9 slots in each row (See Puzzle::slice()), so with the slots holding a piece of the other
+ * face called strays:
+ *
+ *   - No strays need no slice.
+ *   - One slice is only enough if each row's strays are exactly one run of 9 slots, which the slice then swaps.
+ *   - Anything else needs at least two.
+ *
+ * Every stray in one row is matched by one in the other, since each face has exactly a row of pieces. Counting
+ * them and their runs is a popcount over the Face Parity bits (See Binary Slot Format), so the bound costs a few
+ * instructions. Turns never move a piece between rows, and a solution may end on a turn, so this bounds slices and
+ * therefore moves.
+ *
+ * The bound never exceeds two, so it only prunes with fewer moves left than that, where a depth-first search has
+ * nearly all of its nodes. Cube shape is bounded exactly by ShapeTable, which no closed form of the Corner Flags can
+ * improve on.
+ */
+class Bounds {
+public:
+	// Bit 0 of every slot
+	static constexpr Puzzle::Row SLOT_ONES = [] {
+		Puzzle::Row ones = 0;
+		for (int i = 0; i < Puzzle::SLOTS_PER_ROW; ++i) {
+			ones |= static_cast<Puzzle::Row>(1) << (i * Puzzle::SLOT_SIZE);
+		}
+		return ones;
+	}();
+
+	// The Face Parity bit of every slot. See Binary Slot Format
+	static constexpr Puzzle::Row FACE_BITS = SLOT_ONES << 5;
+
+	// The most this class ever bounds a state by
+	static constexpr int MOST = 2;
+
+	/**
+	 * @brief The Face Parity bits of the slots in the top row holding a bottom piece.
+	 */
+	[[nodiscard]] static constexpr Puzzle::Row topStrays(const Puzzle &puzzle) {
+		return puzzle.getTop() & FACE_BITS;
+	}
+
+	/**
+	 * @brief The Face Parity bits of the slots in the bottom row holding a top piece.
+	 */
+	[[nodiscard]] static constexpr Puzzle::Row bottomStrays(const Puzzle &puzzle) {
+		return ~puzzle.getBottom() & FACE_BITS;
+	}
+
+	/**
+	 * @brief The number of slots whose bit is set, one bit per slot.
+	 */
+	[[nodiscard]] static constexpr int count(const Puzzle::Row bits) {
+		return std::popcount(static_cast<uint64_t>(bits)) + std::popcount(static_cast<uint64_t>(bits >> 64));
+	}
+
+	/**
+	 * @brief The number of runs of set slots, the row read as a ring, one bit per slot.
+	 *
+	 * @return 0 if every slot is set.
+	 */
+	[[nodiscard]] static constexpr int runs(const Puzzle::Row bits) {
+		// Each slot moved up by one, the last wrapping around to the first
+		const Puzzle::Row previous = (bits << Puzzle::SLOT_SIZE | bits >> (Puzzle::ROW_BITS - Puzzle::SLOT_SIZE)) &
+		                             Puzzle::ROW_MASK;
+		return count(bits & ~previous);
+	}
+
+	/**
+	 * @brief The fewest slices, and so moves, which can leave each face entirely in its own row.
+	 *
+	 * Admissible for every goal. See class notes
+	 */
+	[[nodiscard]] static constexpr int slicesToSeparate(const Puzzle &puzzle) {
+		const Puzzle::Row top = topStrays(puzzle);
+		if (top == 0) {
+			return 0;
+		}
+		const Puzzle::Row bottom = bottomStrays(puzzle);
+		return count(top) == Puzzle::SLOTS_PER_HALF && runs(top) == 1 && runs(bottom) == 1 ? 1 : MOST;
+	}
+};
+
+static_assert(Bounds::slicesToSeparate(Puzzle()) == 0);
+// A slice from the solved state swaps one run of 9 slots of each face
+static_assert([] {
+	Puzzle puzzle;
+	puzzle.slice();
+	return Bounds::slicesToSeparate(puzzle) == 1 && Bounds::count(Bounds::bottomStrays(puzzle)) == 9;
+}());
+// Slicing again with the top row turned splits the strays, which no single slice can gather
+static_assert([] {
+	Puzzle puzzle;
+	puzzle.slice();
+	puzzle.turn(3, 0);
+	puzzle.slice();
+	return Bounds::slicesToSeparate(puzzle) == Bounds::MOST;
+}());
+
+#endif //BOUNDS_H
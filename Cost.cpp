@@ -0,0 +1,164 @@
+#include "Cost.h"
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <string>
+
+CostSearch::CostSearch(const CostModel &model, const int moveLimit, const MoveSet moveSet, const Goal goal)
+	: model(model), moveLimit(moveLimit), moveSet(moveSet), goal(goal),
+	  layers(goal == Goal::SEPARATED || goal == Goal::MATCHED ? nullptr : &LayerTable::instance()) {
+	if (goal == Goal::MATCHED) {
+		throw std::invalid_argument("Cost search does not support target masks.");
+	}
+	if (moveLimit < 0 || moveLimit > Solver<>::MAX_DEPTH) {
+		throw std::invalid_argument("The move limit must be within [0, " + std::to_string(Solver<>::MAX_DEPTH) + "].");
+	}
+
+	int cheapestRow = INFEASIBLE;
+	int cheapestTurnedRow = INFEASIBLE;
+	for (uint32_t turns = moveSet.turns; turns != 0; turns &= turns - 1) {
+		const int turn = std::countr_zero(turns);
+		const int rowCost = model.perTurn[std::abs(MoveTables::NOTATION[turn])];
+		cheapestRow = std::min(cheapestRow, rowCost);
+		if (turn != 0) {
+			cheapestTurnedRow = std::min(cheapestTurnedRow, rowCost);
+		}
+	}
+	cheapestTurn = model.perMove + 2 * cheapestRow;
+	cheapestMove = cheapestTurn + model.perSlice;
+	// With no turn but 0, every move is a slice alone, and they can't follow one another
+	cheapestTurning = cheapestTurnedRow == INFEASIBLE
+		                  ? cheapestMove
+		                  : model.perMove + cheapestRow + cheapestTurnedRow + model.perSlice;
+}
+
+bool CostSearch::reached(const Puzzle &puzzle) const {
+	switch (goal) {
+		case Goal::SEPARATED:
+			return puzzle.cubeShape() && puzzle.isRowOrientationSolved();
+		case Goal::SOLVED:
+			return puzzle.isSolved();
+		case Goal::TOP_LAYER:
+			return puzzle.isTopSolved();
+		case Goal::BOTTOM_LAYER:
+			return puzzle.isBottomSolved();
+		case Goal::MATCHED:
+			break;
+	}
+	return false;
+}
+
+int CostSearch::estimate(const Puzzle &puzzle, const RowShape topShape, const RowShape bottomShape,
+                         const int movesLeft, const int budget) const {
+	int bound = 0;
+	int moves = 0;
+	// Every move towards cube shape includes its slice
+	if (goal == Goal::SEPARATED || goal == Goal::SOLVED) {
+		moves = ShapeTable::instance().distance(topShape, bottomShape);
+		bound = movesCost(moves);
+	}
+
+	// The last move towards a layer may be a turn alone
+	constexpr int LAYER_MOST = LayerTable::RADIUS + 1;
+	const auto layerCost = [this](const int d) {
+		return d == 0 ? 0 : movesCost(d - 1) + cheapestTurn;
+	};
+	if (layers != nullptr && moves < LAYER_MOST && (movesLeft < LAYER_MOST || layerCost(LAYER_MOST) > budget)) {
+		const int top = goal != Goal::BOTTOM_LAYER ? layers->topDistance(puzzle) : 0;
+		const int bottom = goal != Goal::TOP_LAYER ? layers->bottomDistance(puzzle) : 0;
+		const int layerMoves = std::max(top, bottom);
+		if (layerMoves > moves) {
+			moves = layerMoves;
+			bound = std::max(bound, layerCost(layerMoves));
+		}
+	}
+	return moves > movesLeft ? INFEASIBLE : bound;
+}
+
+bool CostSearch::search(const Puzzle &puzzle, const RowShape topShape, const RowShape bottomShape, const int cost,
+                        Iteration &iteration, const std::atomic<bool> &cancelled) const {
+	if (reached(puzzle)) {
+		iteration.endsOnSlice = true;
+		iteration.cost = cost;
+		return true;
+	}
+	const int movesLeft = moveLimit - static_cast<int>(iteration.path.size());
+	if (movesLeft == 0 || cancelled.load(std::memory_order_relaxed)) {
+		return false;
+	}
+
+	// A goal one turn away ends the solution on that turn
+	for (uint32_t tops = moveSet.turns; tops != 0; tops &= tops - 1) {
+		for (uint32_t bottoms = moveSet.turns; bottoms != 0; bottoms &= bottoms - 1) {
+			const Move move{static_cast<uint8_t>(std::countr_zero(tops)), static_cast<uint8_t>(std::countr_zero(bottoms))};
+			const int total = cost + model.turnCost(move);
+			if (move.isSliceOnly() || total >= iteration.next) {
+				continue;
+			}
+			Puzzle next = puzzle.clone();
+			next.turn(move.top, move.bottom);
+			if (!reached(next)) {
+				continue;
+			}
+			if (total > iteration.bound) {
+				iteration.next = total;
+				continue;
+			}
+			iteration.path.push_back(move);
+			iteration.endsOnSlice = false;
+			iteration.cost = total;
+			return true;
+		}
+	}
+
+	// A slice alone straight after another undoes it. After any other move it may be cheaper, under a model charging
+	// large turns more, than merging the turns either side of it into one
+	const bool sliceOnly = iteration.path.empty() || !iteration.path.back().isSliceOnly();
+	const uint32_t tops = ShapeTable::sliceableTurns(topShape) & moveSet.turns;
+	const uint32_t bottoms = ShapeTable::sliceableTurns(bottomShape) & moveSet.turns;
+	for (uint32_t t = tops; t != 0; t &= t - 1) {
+		for (uint32_t b = bottoms; b != 0; b &= b - 1) {
+			const Move move{static_cast<uint8_t>(std::countr_zero(t)), static_cast<uint8_t>(std::countr_zero(b))};
+			const int total = cost + model.cost(move);
+			if ((!sliceOnly && move.isSliceOnly()) || total >= iteration.next) {
+				continue;
+			}
+			Puzzle next = puzzle.clone();
+			next.turn(move.top, move.bottom);
+			next.slice();
+			RowShape nextTop = ShapeTable::turn(topShape, move.top);
+			RowShape nextBottom = ShapeTable::turn(bottomShape, move.bottom);
+			ShapeTable::slice(nextTop, nextBottom);
+
+			const int h = estimate(next, nextTop, nextBottom, movesLeft - 1, iteration.bound - total);
+			if (h == INFEASIBLE) {
+				continue;
+			}
+			if (total + h > iteration.bound) {
+				iteration.next = std::min(iteration.next, total + h);
+				continue;
+			}
+			iteration.path.push_back(move);
+			if (search(next, nextTop, nextBottom, total, iteration, cancelled)) {
+				return true;
+			}
+			iteration.path.pop_back();
+		}
+	}
+	return false;
+}
+
+std::optional<CostSearch::Result> CostSearch::solve(const Puzzle &start, const std::atomic<bool> &cancelled) const {
+	const RowShape topShape = ShapeTable::shapeOf(start.getTop());
+	const RowShape bottomShape = ShapeTable::shapeOf(start.getBottom());
+
+	int bound = estimate(start, topShape, bottomShape, moveLimit, 0);
+	while (bound != INFEASIBLE && !cancelled.load(std::memory_order_relaxed)) {
+		Iteration iteration{bound, INFEASIBLE, {}, true, 0};
+		if (search(start, topShape, bottomShape, 0, iteration, cancelled)) {
+			return Result{{iteration.path.begin(), iteration.path.end()}, iteration.endsOnSlice, iteration.cost};
+		}
+		bound = iteration.next;
+	}
+	return std::nullopt;
+}
@@ -0,0 +1,166 @@
+#ifndef COST_H
+#define COST_H
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <vector>
+#include "Layer.h"
+#include "Move.h"
+#include "Puzzle.h"
+#include "Shape.h"
+#include "Solver.h"
+
+/**
+ * @file Cost.h
+ *
+ * @brief Shortest solutions under other ways of counting moves.
+ *
+ * The solver counts every (top, bottom) turn and its slice as one move. A CostModel instead charges each move
+ * by what it does: a fixed amount per move, an amount per slice, and an amount per row turned depending on how far,
+ * so that the total turn amount, or a user's preference for small turns, can be minimised instead.
+ *
+ *   slice:   1 per move, as the solver counts.
+ *   twist:   1 per slot turned either way, so a turn of -3 costs 3 and slices are free.
+ *   weights: Any table, written `weights:<move>,<slice>,<turn 1>,...,<turn 9>`.
+ *
+ * ──────────────────────────────────────────────────────────────────────────────────────────────────
+ */
+
+/**
+ * @struct CostModel
+ *
+ * @brief The cost of each move, as non-negative integers.
+ */
+struct CostModel {
+	// The most slots a row can turn either way
+	static constexpr int MOST_TURN = MoveTables::TURNS / 2;
+
+	uint16_t perMove = 1;
+	uint16_t perSlice = 0;
+	// perTurn[k] is charged for each row turned k slots either way
+	std::array<uint16_t, MOST_TURN + 1> perTurn{};
+
+	static CostModel slice() {
+		return {};
+	}
+
+	static CostModel twist() {
+		CostModel model{0, 0, {}};
+		for (int k = 0; k <= MOST_TURN; ++k) {
+			model.perTurn[k] = static_cast<uint16_t>(k);
+		}
+		return model;
+	}
+
+	/**
+	 * @brief The cost of a move's turns, without its slice.
+	 */
+	[[nodiscard]] int turnCost(const Move move) const {
+		return perMove + perTurn[std::abs(move.topNotation())] + perTurn[std::abs(move.bottomNotation())];
+	}
+
+	/**
+	 * @brief The cost of a move including its slice.
+	 */
+	[[nodiscard]] int cost(const Move move) const {
+		return turnCost(move) + perSlice;
+	}
+
+	/**
+	 * @brief The total cost of a solution.
+	 */
+	[[nodiscard]] int cost(const std::vector<Move> &moves, const bool endsOnSlice) const {
+		int total = 0;
+		for (const Move move: moves) {
+			total += cost(move);
+		}
+		return moves.empty() || endsOnSlice ? total : total - perSlice;
+	}
+};
+
+/**
+ * @class CostSearch
+ *
+ * @brief Iterative deepening A* on cost rather than moves, finding a cheapest solution under a CostModel.
+ *
+ * The tables bound moves rather than cost: the shape distance for goals in cube shape (See ShapeTable),
+ * and the layer distance near a solved layer (See LayerTable). A slice alone straight after another only undoes it,
+ * so no two are searched in a row, and at least every other move of a solution turns a row. A bound of d moves is
+ * turned into a bound on cost by charging half of them the least a move turning a row can cost, the rest the least
+ * any move can cost, and all but the last the slice as well, which keeps it admissible under any model. Each iteration raises the cost bound to the least cost that went over it, so the first solution
+ * found is a cheapest one within the move limit.
+ */
+class CostSearch {
+public:
+	struct Result {
+		std::vector<Move> moves;
+		// Whether the last move includes its slice
+		bool endsOnSlice = true;
+		int cost = 0;
+	};
+
+	/**
+	 * @param model How each move is charged.
+	 * @param moveLimit The most moves in a solution, up to Solver::MAX_DEPTH.
+	 * @param moveSet The turn amounts tried for each row.
+	 * @param goal What to search for. Matching a target mask is not supported.
+	 *
+	 * @throws invalid_argument If the goal is Goal::MATCHED or the limit is out of range.
+	 */
+	CostSearch(const CostModel &model, int moveLimit, MoveSet moveSet, Goal goal);
+
+	/**
+	 * @brief Raises the cost bound until a solution is found, the move limit leaves none, or it is cancelled.
+	 */
+	[[nodiscard]] std::optional<Result> solve(const Puzzle &start, const std::atomic<bool> &cancelled) const;
+
+private:
+	using RowShape = ShapeTable::RowShape;
+	using Path = Solver<>::Path;
+
+	struct Iteration {
+		int bound;
+		// The least cost over the bound, for the next iteration
+		int next;
+		Path path;
+		bool endsOnSlice;
+		int cost;
+	};
+
+	static constexpr int INFEASIBLE = 1 << 30;
+
+	CostModel model;
+	int moveLimit;
+	MoveSet moveSet;
+	Goal goal;
+	// The least a move can cost, with and without its slice
+	int cheapestTurn;
+	int cheapestMove;
+	// The least a move other than a slice alone can cost, with its slice
+	int cheapestTurning;
+	const LayerTable *layers;
+
+	[[nodiscard]] bool reached(const Puzzle &puzzle) const;
+
+	/**
+	 * @brief The least a number of moves can cost, each including its slice. See class notes
+	 */
+	[[nodiscard]] int movesCost(const int moves) const {
+		return moves / 2 * cheapestTurning + (moves - moves / 2) * cheapestMove;
+	}
+
+	/**
+	 * @brief A lower bound on the cost to reach the goal, or INFEASIBLE if it needs more moves than are left.
+	 *
+	 * @param budget The cost left under the bound. The layer table is only looked up where it could exceed it.
+	 */
+	[[nodiscard]] int estimate(const Puzzle &puzzle, RowShape topShape, RowShape bottomShape, int movesLeft,
+	                           int budget) const;
+
+	bool search(const Puzzle &puzzle, RowShape topShape, RowShape bottomShape, int cost, Iteration &iteration,
+	            const std::atomic<bool> &cancelled) const;
+};
+
+#endif //COST_H
@@ -0,0 +1,160 @@
+#include "Counter.h"
+#include <algorithm>
+#include <bit>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+SolutionCounter::SolutionCounter(const int limit, const MoveSet moveSet, const Goal goal, const std::size_t maxEntries)
+	: limit(limit), moveSet(moveSet), goal(goal),
+	  goalBits(goal == Goal::SEPARATED ? Solver<>::SEPARATED_BITS : Puzzle::ROW_MASK), maxEntries(maxEntries),
+	  shapes(ShapeTable::instance()),
+	  layers(goal == Goal::SEPARATED || goal == Goal::MATCHED ? nullptr : &LayerTable::instance()) {
+	if (goal == Goal::MATCHED) {
+		throw std::invalid_argument("Counting does not support target masks.");
+	}
+	if (limit < 0 || limit > Solver<>::MAX_DEPTH) {
+		throw std::invalid_argument("The limit must be within [0, " + std::to_string(Solver<>::MAX_DEPTH) + "].");
+	}
+}
+
+bool SolutionCounter::reached(const Puzzle &puzzle) const {
+	switch (goal) {
+		case Goal::SEPARATED:
+			return puzzle.cubeShape() && puzzle.isRowOrientationSolved();
+		case Goal::SOLVED:
+			return puzzle.isSolved();
+		case Goal::TOP_LAYER:
+			return puzzle.isTopSolved();
+		case Goal::BOTTOM_LAYER:
+			return puzzle.isBottomSolved();
+		case Goal::MATCHED:
+			break;
+	}
+	return false;
+}
+
+bool SolutionCounter::prune(const Puzzle &puzzle, const RowShape topShape, const RowShape bottomShape,
+                            const int left) const {
+	if (left < Bounds::MOST && Bounds::slicesToSeparate(puzzle) > left) {
+		return true;
+	}
+	if ((goal == Goal::SEPARATED || goal == Goal::SOLVED) && shapes.distance(topShape, bottomShape) > left) {
+		return true;
+	}
+	if (layers == nullptr || left > LayerTable::RADIUS) {
+		return false;
+	}
+	return (goal != Goal::BOTTOM_LAYER && layers->topDistance(puzzle) > left) ||
+	       (goal != Goal::TOP_LAYER && layers->bottomDistance(puzzle) > left);
+}
+
+uint64_t SolutionCounter::waysAfter(const Puzzle &puzzle, const RowShape topShape, const RowShape bottomShape,
+                                    const Move move, const int left, const std::atomic<bool> &cancelled) {
+	Puzzle next = puzzle.clone();
+	next.turn(move.top, move.bottom);
+	if (left == 1) {
+		const uint64_t beforeSlice = reached(next) ? 1 : 0;
+		next.slice();
+		return beforeSlice + (reached(next) ? 1 : 0);
+	}
+
+	next.slice();
+	RowShape nextTop = ShapeTable::turn(topShape, move.top);
+	RowShape nextBottom = ShapeTable::turn(bottomShape, move.bottom);
+	ShapeTable::slice(nextTop, nextBottom);
+	if (prune(next, nextTop, nextBottom, left - 1)) {
+		return 0;
+	}
+	return ways(next, nextTop, nextBottom, left - 1, cancelled);
+}
+
+uint64_t SolutionCounter::ways(const Puzzle &puzzle, const RowShape topShape, const RowShape bottomShape,
+                               const int left, const std::atomic<bool> &cancelled) {
+	const Key key{puzzle, left};
+	const bool memoized = left >= MEMO_MIN_LEFT;
+	Shard &shard = memo[KeyHash()(key) % SHARDS];
+	if (memoized) {
+		std::lock_guard guard(shard.lock);
+		if (const auto found = shard.counts.find(key); found != shard.counts.end()) {
+			return found->second;
+		}
+	}
+	if (cancelled.load(std::memory_order_relaxed)) {
+		return 0;
+	}
+
+	uint64_t total = 0;
+	const uint32_t bottoms = ShapeTable::sliceableTurns(bottomShape) & moveSet.turns;
+	for (uint32_t tops = ShapeTable::sliceableTurns(topShape) & moveSet.turns; tops != 0; tops &= tops - 1) {
+		for (uint32_t turns = bottoms; turns != 0; turns &= turns - 1) {
+			const Move move{static_cast<uint8_t>(std::countr_zero(tops)), static_cast<uint8_t>(std::countr_zero(turns))};
+			total += waysAfter(puzzle, topShape, bottomShape, move, left, cancelled);
+		}
+	}
+
+	if (memoized && entries.load(std::memory_order_relaxed) < maxEntries) {
+		std::lock_guard guard(shard.lock);
+		if (shard.counts.emplace(key, total).second) {
+			entries.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+	return total;
+}
+
+void SolutionCounter::clear() {
+	for (Shard &shard: memo) {
+		shard.counts.clear();
+	}
+	entries = 0;
+}
+
+std::optional<SolutionCounter::Result> SolutionCounter::count(const Puzzle &state, const bool multithread,
+                                                              const std::atomic<bool> &cancelled) {
+	const Puzzle start(state.getTop() & goalBits, state.getBottom() & goalBits);
+	if (reached(start)) {
+		return Result{0, 1};
+	}
+	const RowShape topShape = ShapeTable::shapeOf(start.getTop());
+	const RowShape bottomShape = ShapeTable::shapeOf(start.getBottom());
+	const uint32_t tops = ShapeTable::sliceableTurns(topShape) & moveSet.turns;
+	const uint32_t bottoms = ShapeTable::sliceableTurns(bottomShape) & moveSet.turns;
+
+	// Counts at fewer moves stay valid at more, so the memo is kept from one depth to the next
+	clear();
+	for (int depth = 1; depth <= limit && !cancelled.load(std::memory_order_relaxed); ++depth) {
+		if (prune(start, topShape, bottomShape, depth)) {
+			continue;
+		}
+
+		uint64_t total = 0;
+		std::vector<std::future<uint64_t> > futures;
+		for (uint32_t t = tops; t != 0; t &= t - 1) {
+			const auto countTop = [this, &start, topShape, bottomShape, bottoms, depth, &cancelled, a = std::countr_zero(t)] {
+				uint64_t sum = 0;
+				for (uint32_t b = bottoms; b != 0; b &= b - 1) {
+					const Move move{static_cast<uint8_t>(a), static_cast<uint8_t>(std::countr_zero(b))};
+					sum += waysAfter(start, topShape, bottomShape, move, depth, cancelled);
+				}
+				return sum;
+			};
+			if (multithread) {
+				futures.push_back(std::async(std::launch::async, countTop));
+			} else {
+				total += countTop();
+			}
+		}
+		for (auto &future: futures) {
+			total += future.get();
+		}
+
+		if (cancelled.load(std::memory_order_relaxed)) {
+			break;
+		}
+		if (total > 0) {
+			return Result{depth, total};
+		}
+	}
+	return std::nullopt;
+}
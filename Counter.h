@@ -0,0 +1,120 @@
+#ifndef COUNTER_H
+#define COUNTER_H
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include "Bounds.h"
+#include "Layer.h"
+#include "Move.h"
+#include "Puzzle.h"
+#include "Shape.h"
+#include "Solver.h"
+
+/**
+ * @class SolutionCounter
+ *
+ * @brief Counts the shortest solutions of a state without listing them, by memoizing how many ways each state
+ * finishes in the moves left.
+ *
+ * A solution is counted exactly as Solver reports it (See Solver::solutions()): a sequence of moves, the last of
+ * which may end on its turn, so the count matches `enumerate` at the optimal depth.
+ *
+ * Many move sequences pass through the same states, so the number of ways a state finishes in d moves is stored
+ * once and reused, which makes counting polynomial in the states reached rather than exponential in the depth.
+ * Only children which the shape and layer tables allow to finish in time are expanded (See Solver::prune()).
+ * For Goal::SEPARATED, states are reduced to the bits the goal and the move generator read, so states which only
+ * differ in which piece is which share their counts.
+ *
+ * The memo is split into shards, each behind its own lock, so the first moves can be counted on every core at once.
+ */
+class SolutionCounter {
+public:
+	struct Result {
+		// The moves in each shortest solution
+		int length;
+		uint64_t solutions;
+	};
+
+	// The most (state, moves left) counts kept before the rest are recomputed instead of stored
+	static constexpr std::size_t DEFAULT_MAX_ENTRIES = 1 << 22;
+
+	/**
+	 * @param limit The most moves to search, up to Solver::MAX_DEPTH.
+	 * @param moveSet The turn amounts tried for each row.
+	 * @param goal What to search for. Matching a target mask is not supported.
+	 * @param maxEntries The most counts kept in the memo.
+	 *
+	 * @throws invalid_argument If the goal is Goal::MATCHED or the limit is out of range.
+	 */
+	SolutionCounter(int limit, MoveSet moveSet, Goal goal, std::size_t maxEntries = DEFAULT_MAX_ENTRIES);
+
+	/**
+	 * @brief Finds the length of a shortest solution and counts the solutions of that length.
+	 *
+	 * @param multithread Whether to count the first moves on every core.
+	 * @return The count, or nothing if there is no solution within the limit or the search was cancelled.
+	 */
+	std::optional<Result> count(const Puzzle &start, bool multithread, const std::atomic<bool> &cancelled);
+
+private:
+	using RowShape = ShapeTable::RowShape;
+
+	struct Key {
+		Puzzle puzzle;
+		int left;
+
+		bool operator==(const Key &) const = default;
+	};
+
+	struct KeyHash {
+		std::size_t operator()(const Key &key) const {
+			return PuzzleHash()(key.puzzle) ^ static_cast<std::size_t>(key.left) * 0x9E3779B97F4A7C15ULL;
+		}
+	};
+
+	struct Shard {
+		std::mutex lock;
+		std::unordered_map<Key, uint64_t, KeyHash> counts;
+	};
+
+	static constexpr std::size_t SHARDS = 64;
+	// Nodes this close to the leaves are cheaper to count again than to look up
+	static constexpr int MEMO_MIN_LEFT = 2;
+
+	int limit;
+	MoveSet moveSet;
+	Goal goal;
+	// The bits of each slot the goal reads. See Solver::SEPARATED_BITS
+	Puzzle::Row goalBits;
+	std::size_t maxEntries;
+	const ShapeTable &shapes;
+	const LayerTable *layers;
+	std::array<Shard, SHARDS> memo;
+	std::atomic<std::size_t> entries = 0;
+
+	[[nodiscard]] bool reached(const Puzzle &puzzle) const;
+
+	/**
+	 * @brief Whether a state is too far from the goal to reach it in the moves left. See Solver::prune()
+	 */
+	[[nodiscard]] bool prune(const Puzzle &puzzle, RowShape topShape, RowShape bottomShape, int left) const;
+
+	/**
+	 * @brief The number of solutions of a state with exactly the given moves left.
+	 */
+	uint64_t ways(const Puzzle &puzzle, RowShape topShape, RowShape bottomShape, int left,
+	              const std::atomic<bool> &cancelled);
+
+	/**
+	 * @brief The number of solutions starting with one move.
+	 */
+	uint64_t waysAfter(const Puzzle &puzzle, RowShape topShape, RowShape bottomShape, Move move, int left,
+	                   const std::atomic<bool> &cancelled);
+
+	void clear();
+};
+
+#endif //COUNTER_H
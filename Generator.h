@@ -0,0 +1,143 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+/**
+ * @class Generator
+ *
+ * @brief A lazily evaluated sequence produced by a coroutine, which runs only while its consumer pulls values.
+ *
+ * The coroutine starts suspended, and each increment of the iterator resumes it until its next co_yield.
+ * Destroying the generator destroys the suspended coroutine with everything on its frame,
+ * so a consumer can stop at any point without the producer running on.
+ * Exceptions thrown by the coroutine are rethrown to the consumer from the increment which resumed it.
+ *
+ * @tparam T The type of the values yielded.
+ */
+template<typename T>
+class Generator {
+public:
+	struct promise_type {
+		// The value of the last co_yield, which lives in the coroutine frame until it is resumed
+		const T *current = nullptr;
+		std::exception_ptr exception;
+
+		Generator get_return_object() {
+			return Generator(std::coroutine_handle<promise_type>::from_promise(*this));
+		}
+
+		std::suspend_always initial_suspend() noexcept {
+			return {};
+		}
+
+		std::suspend_always final_suspend() noexcept {
+			return {};
+		}
+
+		std::suspend_always yield_value(const T &value) noexcept {
+			current = std::addressof(value);
+			return {};
+		}
+
+		void return_void() noexcept {
+		}
+
+		void unhandled_exception() noexcept {
+			exception = std::current_exception();
+		}
+
+		// Only co_yield is meaningful in a generator
+		template<typename U>
+		std::suspend_never await_transform(U &&) = delete;
+	};
+
+	class iterator {
+	public:
+		using iterator_category = std::input_iterator_tag;
+		using difference_type = std::ptrdiff_t;
+		using value_type = T;
+
+		iterator() = default;
+
+		explicit iterator(const std::coroutine_handle<promise_type> coroutine) : coroutine(coroutine) {
+		}
+
+		const T &operator*() const {
+			return *coroutine.promise().current;
+		}
+
+		const T *operator->() const {
+			return coroutine.promise().current;
+		}
+
+		iterator &operator++() {
+			resume(coroutine);
+			return *this;
+		}
+
+		void operator++(int) {
+			++*this;
+		}
+
+		bool operator==(std::default_sentinel_t) const {
+			return !coroutine || coroutine.done();
+		}
+
+	private:
+		std::coroutine_handle<promise_type> coroutine;
+	};
+
+	Generator(Generator &&other) noexcept : coroutine(std::exchange(other.coroutine, {})) {
+	}
+
+	Generator &operator=(Generator &&other) noexcept {
+		if (this != &other) {
+			if (coroutine) {
+				coroutine.destroy();
+			}
+			coroutine = std::exchange(other.coroutine, {});
+		}
+		return *this;
+	}
+
+	Generator(const Generator &) = delete;
+
+	Generator &operator=(const Generator &) = delete;
+
+	~Generator() {
+		if (coroutine) {
+			coroutine.destroy();
+		}
+	}
+
+	/**
+	 * @brief Runs the coroutine to its first value. Only call once.
+	 */
+	iterator begin() {
+		resume(coroutine);
+		return iterator(coroutine);
+	}
+
+	std::default_sentinel_t end() const {
+		return {};
+	}
+
+private:
+	std::coroutine_handle<promise_type> coroutine;
+
+	explicit Generator(const std::coroutine_handle<promise_type> coroutine) : coroutine(coroutine) {
+	}
+
+	static void resume(const std::coroutine_handle<promise_type> coroutine) {
+		coroutine.resume();
+		if (coroutine.promise().exception) {
+			std::rethrow_exception(std::exchange(coroutine.promise().exception, nullptr));
+		}
+	}
+};
+
+#endif //GENERATOR_H
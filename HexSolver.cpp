@@ -0,0 +1,261 @@
+#include "HexSolver.h"
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Layer.h"
+#include "Notation.h"
+#include "Shape.h"
+#include "Simplifier.h"
+#include "Solver.h"
+#include "Validation.h"
+
+static_assert(HEX_MAX_MOVES == Solver<>::MAX_DEPTH);
+static_assert(sizeof(HexState) == 2 * sizeof(Puzzle::Row));
+
+namespace {
+	thread_local std::string lastError;
+
+	Puzzle::Row toRow(const HexRow row) {
+		return static_cast<Puzzle::Row>(row.high) << 64 | row.low;
+	}
+
+	HexRow fromRow(const Puzzle::Row row) {
+		return {static_cast<uint64_t>(row), static_cast<uint64_t>(row >> 64)};
+	}
+
+	Puzzle toPuzzle(const HexState &state) {
+		return {toRow(state.top), toRow(state.bottom)};
+	}
+
+	HexState fromPuzzle(const Puzzle &puzzle) {
+		return {fromRow(puzzle.getTop()), fromRow(puzzle.getBottom())};
+	}
+
+	Goal toGoal(const int32_t goal) {
+		if (goal < HEX_GOAL_SEPARATED || goal > HEX_GOAL_MATCHED) {
+			throw std::invalid_argument("Unknown goal: " + std::to_string(goal));
+		}
+		return static_cast<Goal>(goal);
+	}
+
+	MoveSet toMoveSet(const uint32_t turns) {
+		if (turns >= 1u << MoveTables::TURNS) {
+			throw std::invalid_argument("Turns outside [0, 18) in the move set.");
+		}
+		return turns == 0 ? MoveSet::DEFAULT : MoveSet{turns};
+	}
+
+	/**
+	 * @brief Runs a call, turning any exception into a status for the caller and a message for hex_last_error().
+	 */
+	template<typename Call>
+	int32_t guarded(Call call) {
+		lastError.clear();
+		try {
+			return call();
+		} catch (const std::invalid_argument &e) {
+			lastError = e.what();
+			return HEX_INVALID_ARGUMENT;
+		} catch (const std::exception &e) {
+			lastError = e.what();
+			return HEX_ERROR;
+		} catch (...) {
+			lastError = "Unknown error";
+			return HEX_ERROR;
+		}
+	}
+
+	/**
+	 * @brief A solver reused for every state given to it, recording the first solution it finds.
+	 */
+	class Worker {
+	public:
+		explicit Worker(const HexOptions &options)
+			: limit(options.limit),
+			  multithread(options.multithread != 0),
+			  solver([this](const Solver<>::Path &path, const bool endsOnSlice) {
+				  found = path;
+				  foundEndsOnSlice = endsOnSlice;
+				  return true;
+			  }, options.limit, toMoveSet(options.turns), toGoal(options.goal)) {
+			if (limit < 0 || limit > HEX_MAX_MOVES) {
+				throw std::invalid_argument("The limit must be within [0, " + std::to_string(HEX_MAX_MOVES) + "].");
+			}
+		}
+
+		// The solution handler holds on to this worker
+		Worker(const Worker &) = delete;
+
+		Worker &operator=(const Worker &) = delete;
+
+		void solve(const Puzzle &start, const HexState &targetMask, HexSolution &solution) {
+			solution = HexSolution{};
+			if (!isReachable(start)) {
+				solution.status = HEX_UNREACHABLE;
+				return;
+			}
+			solver.setTargetMask(toRow(targetMask.top), toRow(targetMask.bottom));
+			if (solver.solveOptimal(start, limit, multithread) < 0) {
+				solution.status = HEX_NO_SOLUTION;
+				return;
+			}
+
+			Simplifier simplifier;
+			simplifier.append(found.begin(), found.end(), foundEndsOnSlice);
+			solution.status = HEX_OK;
+			solution.length = static_cast<int32_t>(simplifier.size());
+			solution.ends_on_slice = foundEndsOnSlice;
+			solution.move_count = static_cast<int32_t>(found.size());
+			for (std::size_t i = 0; i < found.size(); ++i) {
+				solution.moves[i][0] = found[i].top;
+				solution.moves[i][1] = found[i].bottom;
+			}
+		}
+
+	private:
+		int limit;
+		bool multithread;
+		Solver<>::Path found;
+		bool foundEndsOnSlice = false;
+		Solver<> solver;
+	};
+}
+
+int32_t hex_abi_version() {
+	return HEX_ABI_VERSION;
+}
+
+const char *hex_last_error() {
+	return lastError.c_str();
+}
+
+int32_t hex_load_tables(const int32_t layers) {
+	return guarded([layers] {
+		ShapeTable::instance();
+		if (layers != 0) {
+			LayerTable::instance();
+		}
+		return HEX_OK;
+	});
+}
+
+void hex_default_options(HexOptions *options) {
+	*options = HexOptions{};
+	options->limit = Solver<>::DEFAULT_MAX_DEPTH;
+	options->turns = MoveSet::DEFAULT.turns;
+	options->goal = HEX_GOAL_SEPARATED;
+	options->multithread = 1;
+}
+
+void hex_solved_state(HexState *state) {
+	*state = fromPuzzle(Puzzle());
+}
+
+int32_t hex_parse_state(const char *text, HexState *state) {
+	return guarded([text, state] {
+		const Puzzle puzzle = parsePuzzle(text);
+		validateState(puzzle);
+		*state = fromPuzzle(puzzle);
+		return HEX_OK;
+	});
+}
+
+int32_t hex_parse_mask(const char *text, HexState *mask) {
+	return guarded([text, mask] {
+		const std::string target = text;
+		if (target == "solved") {
+			*mask = {fromRow(Puzzle::ROW_MASK), fromRow(Puzzle::ROW_MASK)};
+		} else if (target == "separated") {
+			*mask = HexState{};
+		} else {
+			const auto [top, bottom] = parseRows(target);
+			*mask = {fromRow(top), fromRow(bottom)};
+		}
+		return HEX_OK;
+	});
+}
+
+int32_t hex_validate_state(const HexState *state) {
+	return guarded([state] {
+		try {
+			validateState(toPuzzle(*state));
+		} catch (const std::invalid_argument &e) {
+			lastError = e.what();
+			return HEX_UNREACHABLE;
+		}
+		return HEX_OK;
+	});
+}
+
+int32_t hex_solve(const HexState *state, const HexOptions *options, HexSolution *solution) {
+	return guarded([state, options, solution] {
+		Worker worker(*options);
+		worker.solve(toPuzzle(*state), options->target_mask, *solution);
+		return solution->status;
+	});
+}
+
+int32_t hex_solve_batch(const HexState *states, const HexState *target_masks, const size_t count,
+                        const HexOptions *options, HexSolution *solutions) {
+	return guarded([=] {
+		// Checks the options once, before any worker starts
+		[[maybe_unused]] const Worker check(*options);
+		ShapeTable::instance();
+		if (options->goal == HEX_GOAL_TOP_LAYER || options->goal == HEX_GOAL_BOTTOM_LAYER) {
+			LayerTable::instance();
+		}
+
+		// Each worker searches its own range single threaded, as in `batch`
+		HexOptions single = *options;
+		single.multithread = 0;
+		const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+		const std::size_t share = (count + threads - 1) / threads;
+		std::vector<std::future<void> > workers;
+		for (std::size_t first = 0; first < count; first += share) {
+			const std::size_t last = std::min(count, first + share);
+			workers.emplace_back(std::async(std::launch::async, [=] {
+				Worker worker(single);
+				for (std::size_t i = first; i < last; ++i) {
+					worker.solve(toPuzzle(states[i]), target_masks != nullptr ? target_masks[i] : single.target_mask,
+					             solutions[i]);
+				}
+			}));
+		}
+		for (auto &worker: workers) {
+			worker.get();
+		}
+		return HEX_OK;
+	});
+}
+
+size_t hex_format_solution(const HexSolution *solution, char *buffer, const size_t size) {
+	if (size > 0) {
+		buffer[0] = '\0';
+	}
+	std::size_t length = 0;
+	guarded([=, &length] {
+		std::string text;
+		if (solution->status == HEX_OK && solution->move_count >= 0 && solution->move_count <= HEX_MAX_MOVES) {
+			std::vector<Move> moves;
+			for (int i = 0; i < solution->move_count; ++i) {
+				moves.push_back(Move::of(solution->moves[i][0], solution->moves[i][1]));
+			}
+			Simplifier simplifier;
+			simplifier.append(moves.data(), moves.data() + moves.size(), solution->ends_on_slice != 0);
+			simplifier.format(text);
+		}
+		if (size > 0) {
+			const std::size_t copied = std::min(text.size(), size - 1);
+			std::memcpy(buffer, text.data(), copied);
+			buffer[copied] = '\0';
+		}
+		length = text.size();
+		return HEX_OK;
+	});
+	return length;
+}
@@ -0,0 +1,168 @@
+#ifndef HEX_SOLVER_H
+#define HEX_SOLVER_H
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file HexSolver.h
+ *
+ * @brief The C interface of libhexsolver, for calling the solver in-process from other languages. See hexsolver.py
+ *
+ * Every type is plain data with a fixed layout, so arrays of them can be shared with the caller without copying,
+ * and nothing here changes layout or meaning without HEX_ABI_VERSION changing with it.
+ *
+ * No C++ exception crosses the interface. Every function which can fail returns a HexStatus, or 0 for
+ * hex_format_solution(), and describes the failure in hex_last_error(), which is kept per thread.
+ *
+ * The tables are built on first use, which takes a moment, and then stay loaded for the life of the process.
+ * Call hex_load_tables() to pay for them up front.
+ *
+ * ──────────────────────────────────────────────────────────────────────────────────────────────────
+ */
+
+#if defined(HEX_SOLVER_BUILD)
+#define HEX_API __attribute__((visibility("default")))
+#else
+#define HEX_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HEX_ABI_VERSION 1
+
+// The most moves a solution can hold
+#define HEX_MAX_MOVES 32
+
+typedef enum HexStatus {
+	HEX_OK = 0,
+	// No solution within the move limit
+	HEX_NO_SOLUTION = 1,
+	// The state cannot be reached from the solved state. See Validation.h
+	HEX_UNREACHABLE = 2,
+	// An argument was malformed. See hex_last_error()
+	HEX_INVALID_ARGUMENT = 3,
+	// Anything else. See hex_last_error()
+	HEX_ERROR = 4
+} HexStatus;
+
+typedef enum HexGoal {
+	HEX_GOAL_SEPARATED = 0,
+	HEX_GOAL_SOLVED = 1,
+	HEX_GOAL_TOP_LAYER = 2,
+	HEX_GOAL_BOTTOM_LAYER = 3,
+	// Separated, with the bits under a target mask matching the solved state. See Solver::setTargetMask()
+	HEX_GOAL_MATCHED = 4
+} HexGoal;
+
+// One row of the puzzle, split into the low and high 64 bits of a Puzzle::Row. See Binary Slot Format
+typedef struct HexRow {
+	uint64_t low;
+	uint64_t high;
+} HexRow;
+
+// A state, or a pair of target masks. The layout matches a record of a batch file. See Batch.h
+typedef struct HexState {
+	HexRow top;
+	HexRow bottom;
+} HexState;
+
+typedef struct HexOptions {
+	// The most moves to search
+	int32_t limit;
+	// The turn amounts allowed, as a mask with bit t set for a turn of t, or 0 for the default set. See MoveSet
+	uint32_t turns;
+	// A HexGoal
+	int32_t goal;
+	// Whether hex_solve() may search on every core. hex_solve_batch() always does, one state per core at a time
+	int32_t multithread;
+	// The target masks, for HEX_GOAL_MATCHED
+	HexState target_mask;
+} HexOptions;
+
+typedef struct HexSolution {
+	// A HexStatus
+	int32_t status;
+	// The number of moves, as counted in solution notation
+	int32_t length;
+	// Whether the last move includes its slice
+	int32_t ends_on_slice;
+	// The number of entries in moves
+	int32_t move_count;
+	// Each move as its (top, bottom) turns, wrapped to [0, 18) and each followed by a slice, as searched
+	uint8_t moves[HEX_MAX_MOVES][2];
+} HexSolution;
+
+/**
+ * @brief The HEX_ABI_VERSION the library was built with, to check against the caller's.
+ */
+HEX_API int32_t hex_abi_version(void);
+
+/**
+ * @brief Describes the last failure on the calling thread, or is empty.
+ */
+HEX_API const char *hex_last_error(void);
+
+/**
+ * @brief Builds the shape table, and the layer table if asked, so that no later call waits on them.
+ */
+HEX_API int32_t hex_load_tables(int32_t layers);
+
+/**
+ * @brief Fills in the default options: a separated goal within 9 moves of the default move set, on every core.
+ */
+HEX_API void hex_default_options(HexOptions *options);
+
+/**
+ * @brief The solved state.
+ */
+HEX_API void hex_solved_state(HexState *state);
+
+/**
+ * @brief Parses a state from a scramble or the hexadecimal state format, checking that it can be reached.
+ */
+HEX_API int32_t hex_parse_state(const char *text, HexState *state);
+
+/**
+ * @brief Parses target masks from the hexadecimal state format, or `solved` or `separated`.
+ */
+HEX_API int32_t hex_parse_mask(const char *text, HexState *mask);
+
+/**
+ * @brief Checks that a state can be reached, describing why not in hex_last_error().
+ *
+ * @return HEX_OK or HEX_UNREACHABLE.
+ */
+HEX_API int32_t hex_validate_state(const HexState *state);
+
+/**
+ * @brief Finds a shortest solution of a state.
+ *
+ * @return The status of the solution, which is also stored in it.
+ */
+HEX_API int32_t hex_solve(const HexState *state, const HexOptions *options, HexSolution *solution);
+
+/**
+ * @brief Finds a shortest solution of every state in an array, on every core, into an array of the same length.
+ *
+ * @param target_masks An array of target masks, one per state, for HEX_GOAL_MATCHED, or null to use the options'.
+ * @return HEX_OK if every state was searched, whatever its status, or the reason none were.
+ */
+HEX_API int32_t hex_solve_batch(const HexState *states, const HexState *target_masks, size_t count,
+                                const HexOptions *options, HexSolution *solutions);
+
+/**
+ * @brief Writes a solution in solution notation, simplified. See Simplifier.h
+ *
+ * @param buffer Receives the text, always null terminated unless size is 0.
+ * @return The length of the whole text, which was cut short if it is not below size, or 0 with an empty buffer if it
+ * couldn't be formatted. See hex_last_error()
+ */
+HEX_API size_t hex_format_solution(const HexSolution *solution, char *buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //HEX_SOLVER_H
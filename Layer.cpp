@@ -0,0 +1,111 @@
+#include "Layer.h"
+#include <algorithm>
+#include <bit>
+#include <vector>
+#include "Bounds.h"
+#include "Shape.h"
+#include "Symmetry.h"
+
+namespace {
+	constexpr int SLOTS = Puzzle::SLOTS_PER_ROW;
+	// Corners on each face, which is the number of right halves in a row of one face
+	constexpr int CORNERS_PER_FACE = 6;
+
+	// Bits of a slot. See Binary Slot Format
+	constexpr Puzzle::Row FACE_PARITY = 0x20;
+	constexpr Puzzle::Row CORNER_PARITY = 0x10;
+	constexpr Puzzle::Row CORNER_FLAG = 0x01;
+	// The bits of the Piece ID besides the Corner Flag
+	constexpr Puzzle::Row IDENTITY_BITS = 0x0E;
+
+	Puzzle::Row rotate(const Puzzle::Row row, const int slots) {
+		const int shift = slots * Puzzle::SLOT_SIZE;
+		return (row >> shift | row << (Puzzle::ROW_BITS - shift)) & Puzzle::ROW_MASK;
+	}
+
+	Puzzle::Row lowestRotation(const Puzzle::Row row) {
+		Puzzle::Row lowest = row;
+		for (int slots = 1; slots < SLOTS; ++slots) {
+			lowest = std::min(lowest, rotate(row, slots));
+		}
+		return lowest;
+	}
+
+	Puzzle::Row abstractRow(const Puzzle::Row row) {
+		const Puzzle::Row bottomFace = (row & Bounds::FACE_BITS) >> 5;
+		return row & ~(bottomFace * IDENTITY_BITS);
+	}
+}
+
+const LayerTable &LayerTable::instance() {
+	static const LayerTable table;
+	return table;
+}
+
+Puzzle LayerTable::abstract(const Puzzle &puzzle) {
+	return {lowestRotation(abstractRow(puzzle.getTop())), lowestRotation(abstractRow(puzzle.getBottom()))};
+}
+
+LayerTable::LayerTable() {
+	// Once the top layer is solved, the bottom row holds every piece of the bottom face, which are only told apart
+	// by their shape, so there is one goal for each shape of a row with a face's worth of corners.
+	const Puzzle::Row solvedTop = abstract(Puzzle()).getTop();
+	distances.reserve(EXPECTED_SIZE);
+	std::vector<Puzzle> frontier;
+	for (ShapeTable::RowShape shape = 0; shape < 1u << SLOTS; ++shape) {
+		if (std::popcount(shape) != CORNERS_PER_FACE || (shape & ShapeTable::turn(shape, SLOTS - 1)) != 0) {
+			continue;
+		}
+
+		Puzzle::Row bottom = 0;
+		for (int i = 0; i < SLOTS; ++i) {
+			Puzzle::Row slot = FACE_PARITY;
+			if ((shape >> i & 1) != 0) {
+				slot |= CORNER_PARITY | CORNER_FLAG;
+			} else if ((shape >> (i + SLOTS - 1) % SLOTS & 1) != 0) {
+				slot |= CORNER_FLAG;
+			}
+			bottom |= slot << (i * Puzzle::SLOT_SIZE);
+		}
+
+		const Puzzle goal = abstract(Puzzle(solvedTop, bottom));
+		if (distances.try_emplace(goal, 0).second) {
+			frontier.push_back(goal);
+		}
+	}
+
+	// Slices are their own inverse and turns are free, so the states one move from a set are those one move back.
+	for (uint8_t depth = 0; depth < RADIUS; ++depth) {
+		std::vector<Puzzle> next;
+		for (const Puzzle &state: frontier) {
+			const uint32_t tops = ShapeTable::sliceableTurns(ShapeTable::shapeOf(state.getTop()));
+			const uint32_t bottoms = ShapeTable::sliceableTurns(ShapeTable::shapeOf(state.getBottom()));
+			for (uint32_t t = tops; t != 0; t &= t - 1) {
+				for (uint32_t b = bottoms; b != 0; b &= b - 1) {
+					Puzzle after = state.clone();
+					after.turn(std::countr_zero(t), std::countr_zero(b));
+					after.slice();
+
+					const Puzzle key = abstract(after);
+					if (distances.try_emplace(key, depth + 1).second) {
+						next.push_back(key);
+					}
+				}
+			}
+		}
+		frontier = std::move(next);
+	}
+}
+
+uint8_t LayerTable::topDistance(const Puzzle &puzzle) const {
+	const auto found = distances.find(abstract(puzzle));
+	return found != distances.end() ? found->second : RADIUS + 1;
+}
+
+uint8_t LayerTable::bottomDistance(const Puzzle &puzzle) const {
+	return topDistance(Symmetry::apply(puzzle, Symmetry::FLIP));
+}
+
+std::size_t LayerTable::size() const {
+	return distances.size();
+}
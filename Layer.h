@@ -0,0 +1,65 @@
+#ifndef LAYER_H
+#define LAYER_H
+#include <cstdint>
+#include <unordered_map>
+#include "Puzzle.h"
+
+/**
+ * @class LayerTable
+ *
+ * @brief How far the states near a solved layer are from it, for searches which only solve one layer.
+ *
+ * The table abstracts a state to the pieces of the top face exactly, with the pieces of the bottom face reduced to
+ * their face, Corner Parity and Corner Flag (See Binary Slot Format), so it only depends on the layer being solved.
+ * As in ShapeTable, turning either row never changes the distance, so each row is stored at its lowest rotation,
+ * and a distance of d means d moves are needed, the last of which may be a turn.
+ *
+ * Even abstracted, the space is far too large to store, so only the states within RADIUS moves of a solved top
+ * layer are kept, and any other state is known to be at least RADIUS + 1 moves away. That is enough to prune every
+ * node in the last RADIUS moves of a search which isn't on its way to a solution.
+ *
+ * The flip maps the solved state onto itself (See Symmetry.h), so the bottom layer of a state is solved exactly when
+ * the top layer of its flip is, and the one table serves both layers.
+ *
+ * The table is built by a breadth first search from every solved top layer the first time it is used.
+ */
+class LayerTable {
+public:
+	// The most moves from a solved layer that the table holds
+	static constexpr uint8_t RADIUS = 2;
+
+	/**
+	 * @brief Gets the shared table, building it on first use.
+	 */
+	static const LayerTable &instance();
+
+	/**
+	 * @brief A lower bound on the moves needed to solve the top row, exact up to RADIUS.
+	 */
+	[[nodiscard]] uint8_t topDistance(const Puzzle &puzzle) const;
+
+	/**
+	 * @brief A lower bound on the moves needed to solve the bottom row, exact up to RADIUS.
+	 */
+	[[nodiscard]] uint8_t bottomDistance(const Puzzle &puzzle) const;
+
+	/**
+	 * @brief The number of abstract states held.
+	 */
+	[[nodiscard]] std::size_t size() const;
+
+private:
+	// The number of states within RADIUS of a solved layer, to size the table up front
+	static constexpr std::size_t EXPECTED_SIZE = 232666;
+
+	std::unordered_map<Puzzle, uint8_t, PuzzleHash> distances;
+
+	/**
+	 * @brief Reduces the bottom face's pieces to their shape and turns both rows to their lowest rotation.
+	 */
+	static Puzzle abstract(const Puzzle &puzzle);
+
+	LayerTable();
+};
+
+#endif //LAYER_H
@@ -0,0 +1,293 @@
+#include "Macro.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <map>
+#include <stdexcept>
+#include "Notation.h"
+#include "PieceIndex.h"
+
+namespace {
+	constexpr int SLOTS = Puzzle::SLOTS_PER_ROW;
+
+	/**
+	 * @brief Moves slot i + slots of a row to slot i, as Puzzle::turn() does.
+	 */
+	Puzzle::Row rotate(const Puzzle::Row row, const int slots) {
+		if (slots == 0) {
+			return row;
+		}
+		const int shift = slots * Puzzle::SLOT_SIZE;
+		return (row >> shift | row << (Puzzle::ROW_BITS - shift)) & Puzzle::ROW_MASK;
+	}
+}
+
+void MacroTable::add(const std::vector<Move> &moves) {
+	if (moves.empty() || moves.size() > MAX_LENGTH) {
+		throw std::invalid_argument("A macro needs between 1 and " + std::to_string(MAX_LENGTH) + " moves.");
+	}
+
+	// Follow where each slot ends up, labelled by its row and position at the start, as if each held its own piece.
+	// A label is row * SLOTS + slot, which fits in a slot. The moves aren't checked, only followed
+	Puzzle::Row labelled[2] = {};
+	for (int row = 0; row < 2; ++row) {
+		for (int slot = 0; slot < SLOTS; ++slot) {
+			labelled[row] |= static_cast<Puzzle::Row>(row * SLOTS + slot) << (slot * Puzzle::SLOT_SIZE);
+		}
+	}
+	PieceIndex labels(Puzzle(labelled[0], labelled[1]));
+	for (const Move move: moves) {
+		labels.move(move.top, move.bottom);
+	}
+
+	Macro macro{moves, {}};
+	for (uint8_t to = 0; to < 2; ++to) {
+		for (int slot = 0; slot < SLOTS; ++slot) {
+			const uint8_t label = labels.pieceAt(to, slot);
+			const auto from = static_cast<uint8_t>(label / SLOTS);
+			const int origin = label % SLOTS;
+			const auto shift = static_cast<uint8_t>((origin - slot + SLOTS) % SLOTS);
+			const Puzzle::Row bits = Puzzle::SLOT_MASK << (slot * Puzzle::SLOT_SIZE);
+			const auto segment = std::find_if(macro.segments.begin(), macro.segments.end(), [&](const Segment &s) {
+				return s.from == from && s.to == to && s.shift == shift;
+			});
+			if (segment != macro.segments.end()) {
+				segment->mask |= bits;
+			} else {
+				macro.segments.push_back({from, to, shift, bits});
+			}
+		}
+	}
+
+	longestMacro = table.empty() ? moves.size() : std::max(longestMacro, moves.size());
+	table.push_back(std::move(macro));
+}
+
+MacroTable MacroTable::read(std::istream &in) {
+	MacroTable macros;
+	std::string line;
+	for (std::size_t number = 1; std::getline(in, line); ++number) {
+		if (line.find_first_not_of(" \t\r") == std::string::npos || line[line.find_first_not_of(" \t")] == '#') {
+			continue;
+		}
+		try {
+			bool endsOnSlice = true;
+			const std::vector<Move> moves = parseMoves(line, endsOnSlice);
+			if (!endsOnSlice) {
+				throw std::invalid_argument("A macro must end on a slice.");
+			}
+			macros.add(moves);
+		} catch (const std::invalid_argument &e) {
+			throw std::invalid_argument("Line " + std::to_string(number) + ": " + e.what());
+		}
+	}
+	return macros;
+}
+
+MacroTable MacroTable::learn(std::istream &in, const std::size_t length, const std::size_t count) {
+	if (length < 2 || length > MAX_LENGTH) {
+		throw std::invalid_argument("The macro length must be within [2, " + std::to_string(MAX_LENGTH) + "].");
+	}
+
+	// Sub-sequences keyed by their turns, one byte per row and move
+	std::map<std::string, std::size_t> seen;
+	std::string line;
+	for (std::size_t number = 1; std::getline(in, line); ++number) {
+		const std::size_t tab = line.find('\t');
+		const std::string text = tab == std::string::npos ? line : line.substr(tab + 1);
+		if (text.find('/') == std::string::npos) {
+			continue;
+		}
+		bool endsOnSlice = true;
+		std::vector<Move> moves;
+		try {
+			moves = parseMoves(text, endsOnSlice);
+		} catch (const std::invalid_argument &e) {
+			throw std::invalid_argument("Line " + std::to_string(number) + ": " + e.what());
+		}
+		const std::size_t sliced = endsOnSlice ? moves.size() : moves.size() - 1;
+		for (std::size_t first = 0; first + length <= sliced; ++first) {
+			std::string key;
+			for (std::size_t i = first; i < first + length; ++i) {
+				key += static_cast<char>(moves[i].top);
+				key += static_cast<char>(moves[i].bottom);
+			}
+			++seen[key];
+		}
+	}
+
+	std::vector<std::pair<std::string, std::size_t> > ranked(seen.begin(), seen.end());
+	std::stable_sort(ranked.begin(), ranked.end(), [](const auto &a, const auto &b) {
+		return a.second > b.second;
+	});
+	ranked.resize(std::min(ranked.size(), count));
+
+	MacroTable macros;
+	for (const auto &[key, times]: ranked) {
+		std::vector<Move> moves;
+		for (std::size_t i = 0; i < key.size(); i += 2) {
+			moves.push_back({static_cast<uint8_t>(key[i]), static_cast<uint8_t>(key[i + 1])});
+		}
+		macros.add(moves);
+	}
+	return macros;
+}
+
+void MacroTable::write(std::ostream &out) const {
+	for (const Macro &macro: table) {
+		std::vector<int_fast32_t> encoded;
+		for (const Move move: macro.moves) {
+			encoded.push_back(move.encode());
+		}
+		out << formatScramble(encoded, true) << '\n';
+	}
+}
+
+bool MacroTable::applicable(const Macro &macro, RowShape &topShape, RowShape &bottomShape) {
+	for (const Move move: macro.moves) {
+		if ((ShapeTable::sliceableTurns(topShape) >> move.top & 1) == 0 ||
+		    (ShapeTable::sliceableTurns(bottomShape) >> move.bottom & 1) == 0) {
+			return false;
+		}
+		topShape = ShapeTable::turn(topShape, move.top);
+		bottomShape = ShapeTable::turn(bottomShape, move.bottom);
+		ShapeTable::slice(topShape, bottomShape);
+	}
+	return true;
+}
+
+Puzzle MacroTable::apply(const Macro &macro, const Puzzle &puzzle) {
+	const std::array<Puzzle::Row, 2> rows = {puzzle.getTop(), puzzle.getBottom()};
+	std::array<Puzzle::Row, 2> next = {0, 0};
+	for (const Segment &segment: macro.segments) {
+		next[segment.to] |= rotate(rows[segment.from], segment.shift) & segment.mask;
+	}
+	return {next[0], next[1]};
+}
+
+MacroSearch::MacroSearch(const MacroTable &macros, const int maxSteps, const int moveLimit, const MoveSet moveSet,
+                         const Goal goal) : macros(macros), maxSteps(maxSteps), moveLimit(moveLimit),
+                                            moveSet(moveSet), goal(goal),
+                                            cubeGoal(goal == Goal::SEPARATED || goal == Goal::SOLVED) {
+	if (goal == Goal::MATCHED) {
+		throw std::invalid_argument("Macro search does not support target masks.");
+	}
+	if (maxSteps < 0 || moveLimit < 0 || moveLimit > Solver<>::MAX_DEPTH) {
+		throw std::invalid_argument("The move limit must be within [0, " + std::to_string(Solver<>::MAX_DEPTH) + "].");
+	}
+}
+
+bool MacroSearch::reached(const Puzzle &puzzle) const {
+	switch (goal) {
+		case Goal::SEPARATED:
+			return puzzle.cubeShape() && puzzle.isRowOrientationSolved();
+		case Goal::SOLVED:
+			return puzzle.isSolved();
+		case Goal::TOP_LAYER:
+			return puzzle.isTopSolved();
+		case Goal::BOTTOM_LAYER:
+			return puzzle.isBottomSolved();
+		case Goal::MATCHED:
+			break;
+	}
+	return false;
+}
+
+bool MacroSearch::search(const Puzzle &puzzle, const RowShape topShape, const RowShape bottomShape,
+                         const int stepsLeft, Path &path, bool &endsOnSlice,
+                         const std::atomic<bool> &cancelled) const {
+	if (reached(puzzle)) {
+		endsOnSlice = true;
+		return true;
+	}
+	const int movesLeft = moveLimit - static_cast<int>(path.size());
+	if (stepsLeft == 0 || movesLeft == 0 || cancelled.load(std::memory_order_relaxed)) {
+		return false;
+	}
+
+	const int distance = cubeGoal ? ShapeTable::instance().distance(topShape, bottomShape) : 0;
+	if (distance > movesLeft || distance > stepsLeft * static_cast<int>(macros.longest())) {
+		return false;
+	}
+
+	// A goal one turn away ends the solution on that turn
+	if (distance == 0) {
+		for (uint32_t tops = moveSet.turns; tops != 0; tops &= tops - 1) {
+			for (uint32_t bottoms = moveSet.turns; bottoms != 0; bottoms &= bottoms - 1) {
+				const Move move{static_cast<uint8_t>(std::countr_zero(tops)), static_cast<uint8_t>(std::countr_zero(bottoms))};
+				if (move.isSliceOnly()) {
+					continue;
+				}
+				Puzzle next = puzzle.clone();
+				next.turn(move.top, move.bottom);
+				if (reached(next)) {
+					path.push_back(move);
+					endsOnSlice = false;
+					return true;
+				}
+			}
+		}
+	}
+
+	// Two slices in a row undo each other
+	const bool afterSlice = !path.empty() && path.back().isSliceOnly();
+	const uint32_t tops = ShapeTable::sliceableTurns(topShape) & moveSet.turns;
+	const uint32_t bottoms = ShapeTable::sliceableTurns(bottomShape) & moveSet.turns;
+	for (uint32_t t = tops; t != 0; t &= t - 1) {
+		for (uint32_t b = bottoms; b != 0; b &= b - 1) {
+			const Move move{static_cast<uint8_t>(std::countr_zero(t)), static_cast<uint8_t>(std::countr_zero(b))};
+			if (afterSlice && move.isSliceOnly()) {
+				continue;
+			}
+			Puzzle next = puzzle.clone();
+			next.turn(move.top, move.bottom);
+			next.slice();
+			RowShape nextTop = ShapeTable::turn(topShape, move.top);
+			RowShape nextBottom = ShapeTable::turn(bottomShape, move.bottom);
+			ShapeTable::slice(nextTop, nextBottom);
+
+			path.push_back(move);
+			if (search(next, nextTop, nextBottom, stepsLeft - 1, path, endsOnSlice, cancelled)) {
+				return true;
+			}
+			path.pop_back();
+		}
+	}
+
+	for (const MacroTable::Macro &macro: macros.macros()) {
+		if (static_cast<int>(macro.moves.size()) > movesLeft) {
+			continue;
+		}
+		RowShape nextTop = topShape;
+		RowShape nextBottom = bottomShape;
+		if (!MacroTable::applicable(macro, nextTop, nextBottom)) {
+			continue;
+		}
+		for (const Move move: macro.moves) {
+			path.push_back(move);
+		}
+		if (search(MacroTable::apply(macro, puzzle), nextTop, nextBottom, stepsLeft - 1, path, endsOnSlice,
+		           cancelled)) {
+			return true;
+		}
+		for (std::size_t i = 0; i < macro.moves.size(); ++i) {
+			path.pop_back();
+		}
+	}
+	return false;
+}
+
+std::optional<MacroSearch::Result> MacroSearch::solve(const Puzzle &start, const std::atomic<bool> &cancelled) const {
+	const RowShape topShape = ShapeTable::shapeOf(start.getTop());
+	const RowShape bottomShape = ShapeTable::shapeOf(start.getBottom());
+	ShapeTable::instance();
+
+	for (int steps = 0; steps <= maxSteps && !cancelled.load(std::memory_order_relaxed); ++steps) {
+		Path path;
+		bool endsOnSlice = true;
+		if (search(start, topShape, bottomShape, steps, path, endsOnSlice, cancelled)) {
+			return Result{{path.begin(), path.end()}, endsOnSlice};
+		}
+	}
+	return std::nullopt;
+}
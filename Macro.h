@@ -0,0 +1,176 @@
+#ifndef MACRO_H
+#define MACRO_H
+#include <atomic>
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <string>
+#include <vector>
+#include "Move.h"
+#include "Puzzle.h"
+#include "Shape.h"
+#include "Solver.h"
+
+/**
+ * @file Macro.h
+ *
+ * @brief Searching with macro-operators: short move sequences applied as a single step.
+ *
+ * Turns and slices only ever move whole slots, so any sequence of them has the same net effect on every state,
+ * a permutation of the 36 slots. A macro stores that permutation grouped into segments, each a set of slots moving
+ * from one row to another by the same rotation, so applying a whole sequence costs a few shifts and masks.
+ *
+ * A macro can only be applied where each of its slices is allowed, which depends on the shapes of the rows.
+ * That is checked by replaying its moves on the shapes alone (See ShapeTable), which also yields the shapes after it.
+ *
+ * ──────────────────────────────────────────────────────────────────────────────────────────────────
+ */
+
+/**
+ * @class MacroTable
+ *
+ * @brief A list of macros, read from or written to a text file with one sequence per line in solution notation.
+ */
+class MacroTable {
+public:
+	using RowShape = ShapeTable::RowShape;
+
+	// The most moves in one macro
+	static constexpr std::size_t MAX_LENGTH = 8;
+
+	/**
+	 * @brief Slots moving from one row to another by the same rotation.
+	 */
+	struct Segment {
+		// 0 for the top row, 1 for the bottom
+		uint8_t from;
+		uint8_t to;
+		// New slot i of `to` is old slot (i + shift) % 18 of `from`
+		uint8_t shift;
+		// The slots of `to` filled by this segment
+		Puzzle::Row mask;
+	};
+
+	struct Macro {
+		// Every move includes its slice
+		std::vector<Move> moves;
+		std::vector<Segment> segments;
+	};
+
+	MacroTable() = default;
+
+	/**
+	 * @brief Reads one macro per line, skipping empty lines and lines starting with '#'.
+	 *
+	 * @throws invalid_argument If a line is malformed, ends on a turn, or holds no moves or more than MAX_LENGTH.
+	 */
+	static MacroTable read(std::istream &in);
+
+	/**
+	 * @brief Collects the sub-sequences seen most often in a list of solutions.
+	 *
+	 * Each line is a solution in solution notation, optionally after a length and a tab as printed by `batch`.
+	 * Lines without a solution, such as `unreachable`, are skipped.
+	 *
+	 * @param length The moves in each macro.
+	 * @param count The most macros to keep.
+	 * @throws invalid_argument If the length is not within [2, MAX_LENGTH], or a solution is malformed.
+	 */
+	static MacroTable learn(std::istream &in, std::size_t length, std::size_t count);
+
+	/**
+	 * @brief Adds a macro, working out its net effect.
+	 *
+	 * @throws invalid_argument If it holds no moves or more than MAX_LENGTH.
+	 */
+	void add(const std::vector<Move> &moves);
+
+	/**
+	 * @brief Writes one macro per line, in a form read() accepts.
+	 */
+	void write(std::ostream &out) const;
+
+	[[nodiscard]] const std::vector<Macro> &macros() const {
+		return table;
+	}
+
+	[[nodiscard]] std::size_t size() const {
+		return table.size();
+	}
+
+	/**
+	 * @brief The most moves in any macro, or 1 for an empty table.
+	 */
+	[[nodiscard]] std::size_t longest() const {
+		return longestMacro;
+	}
+
+	/**
+	 * @brief Checks that each slice of a macro is allowed from the given shapes, updating them to the shapes after it.
+	 *
+	 * @return FALSE, leaving the shapes in an unspecified state, if a slice is blocked.
+	 */
+	static bool applicable(const Macro &macro, RowShape &topShape, RowShape &bottomShape);
+
+	/**
+	 * @brief Applies a macro's net effect in one step. Only valid where it is applicable.
+	 */
+	static Puzzle apply(const Macro &macro, const Puzzle &puzzle);
+
+private:
+	std::vector<Macro> table;
+	std::size_t longestMacro = 1;
+};
+
+/**
+ * @class MacroSearch
+ *
+ * @brief Iterative deepening over steps, where a step is either a single move or a whole macro. See MacroTable
+ *
+ * The depth counts steps, so a solution made of a few macros is found at a small depth however many moves it holds,
+ * and the moves themselves are bounded separately. Nodes are pruned by the shape distance against the moves left,
+ * and against the most moves the steps left can make. Solutions are not necessarily shortest in moves.
+ */
+class MacroSearch {
+public:
+	struct Result {
+		std::vector<Move> moves;
+		// Whether the last move includes its slice
+		bool endsOnSlice = true;
+	};
+
+	/**
+	 * @param macros The macros tried at every node, after the single moves.
+	 * @param maxSteps The most steps to search.
+	 * @param moveLimit The most moves in a solution, up to Solver::MAX_DEPTH.
+	 * @param moveSet The turn amounts tried for each row in single moves. Macros may use any.
+	 * @param goal What to search for. Matching a target mask is not supported.
+	 *
+	 * @throws invalid_argument If the goal is Goal::MATCHED or the limits are out of range.
+	 */
+	MacroSearch(const MacroTable &macros, int maxSteps, int moveLimit, MoveSet moveSet, Goal goal);
+
+	/**
+	 * @brief Searches one step deeper at a time until a solution is found, the limits are reached, or it is cancelled.
+	 */
+	[[nodiscard]] std::optional<Result> solve(const Puzzle &start, const std::atomic<bool> &cancelled) const;
+
+private:
+	using RowShape = ShapeTable::RowShape;
+	using Path = Solver<>::Path;
+
+	const MacroTable &macros;
+	int maxSteps;
+	int moveLimit;
+	MoveSet moveSet;
+	Goal goal;
+	// Whether the goal is in cube shape, so that the shape distance bounds the moves left
+	bool cubeGoal;
+
+	[[nodiscard]] bool reached(const Puzzle &puzzle) const;
+
+	bool search(const Puzzle &puzzle, RowShape topShape, RowShape bottomShape, int stepsLeft, Path &path,
+	            bool &endsOnSlice, const std::atomic<bool> &cancelled) const;
+};
+
+#endif //MACRO_H
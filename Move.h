@@ -0,0 +1,249 @@
+#ifndef MOVE_H
+#define MOVE_H
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include "Puzzle.h"
+
+/**
+ * @file Move.h
+ *
+ * @brief Compact move algebra.
+ *
+ * A turn of a single row always fits in a byte, wrapped to [0, 18), so every operation on it is a lookup
+ * into a small table built at compile time instead of a chain of `%`.
+ * A Move is a (top, bottom) pair of turns followed by a slice, two bytes in total,
+ * which is small enough that a whole search path is a single short array.
+ *
+ * ──────────────────────────────────────────────────────────────────────────────────────────────────
+ */
+
+namespace MoveTables {
+	constexpr int TURNS = Puzzle::SLOTS_PER_ROW;
+
+	// INVERSE[t] undoes a turn of t
+	constexpr std::array<uint8_t, TURNS> INVERSE = [] {
+		std::array<uint8_t, TURNS> table{};
+		for (int t = 0; t < TURNS; ++t) {
+			table[t] = static_cast<uint8_t>((TURNS - t) % TURNS);
+		}
+		return table;
+	}();
+
+	// COMPOSE[a][b] is a turn of a followed by a turn of b
+	constexpr std::array<std::array<uint8_t, TURNS>, TURNS> COMPOSE = [] {
+		std::array<std::array<uint8_t, TURNS>, TURNS> table{};
+		for (int a = 0; a < TURNS; ++a) {
+			for (int b = 0; b < TURNS; ++b) {
+				table[a][b] = static_cast<uint8_t>((a + b) % TURNS);
+			}
+		}
+		return table;
+	}();
+
+	// NOTATION[t] is the turn written in the range (-8, 9]. See Puzzle::wrapNegative()
+	constexpr std::array<int8_t, TURNS> NOTATION = [] {
+		std::array<int8_t, TURNS> table{};
+		for (int t = 0; t < TURNS; ++t) {
+			table[t] = static_cast<int8_t>(t <= TURNS / 2 ? t : t - TURNS);
+		}
+		return table;
+	}();
+
+	static_assert(INVERSE[0] == 0 && INVERSE[1] == 17 && INVERSE[9] == 9);
+	static_assert(COMPOSE[17][2] == 1 && COMPOSE[9][9] == 0);
+	static_assert(NOTATION[9] == 9 && NOTATION[10] == -8 && NOTATION[17] == -1);
+}
+
+/**
+ * @struct Move
+ *
+ * @brief A turn of each row, both wrapped to [0, 18), followed by a slice.
+ */
+struct Move {
+	uint8_t top = 0;
+	uint8_t bottom = 0;
+
+	/**
+	 * @brief Builds a move from any turn amounts, wrapping them.
+	 */
+	static constexpr Move of(const int topTurns, const int bottomTurns) {
+		constexpr int TURNS = MoveTables::TURNS;
+		return {
+			static_cast<uint8_t>((topTurns % TURNS + TURNS) % TURNS),
+			static_cast<uint8_t>((bottomTurns % TURNS + TURNS) % TURNS)
+		};
+	}
+
+	/**
+	 * @brief Converts from an integer made by Puzzle::encodeMove().
+	 */
+	static constexpr Move decode(const int_fast32_t move) {
+		return {
+			static_cast<uint8_t>(move >> Puzzle::SLOT_SIZE & Puzzle::SLOT_MASK),
+			static_cast<uint8_t>(move & Puzzle::SLOT_MASK)
+		};
+	}
+
+	/**
+	 * @brief Converts to the integer Puzzle::encodeMove() would make.
+	 */
+	[[nodiscard]] constexpr int_fast32_t encode() const {
+		return static_cast<int_fast32_t>(top) << Puzzle::SLOT_SIZE | bottom;
+	}
+
+	/**
+	 * @brief The turns which undo this move's turns.
+	 */
+	[[nodiscard]] constexpr Move inverse() const {
+		return {MoveTables::INVERSE[top], MoveTables::INVERSE[bottom]};
+	}
+
+	/**
+	 * @brief The turns of this move followed by the turns of another, as one turn of each row.
+	 */
+	[[nodiscard]] constexpr Move then(const Move other) const {
+		return {MoveTables::COMPOSE[top][other.top], MoveTables::COMPOSE[bottom][other.bottom]};
+	}
+
+	/**
+	 * @brief Whether neither row is turned, leaving only the slice.
+	 */
+	[[nodiscard]] constexpr bool isSliceOnly() const {
+		return top == 0 && bottom == 0;
+	}
+
+	/**
+	 * @brief The top turn written in the range (-8, 9].
+	 */
+	[[nodiscard]] constexpr int topNotation() const {
+		return MoveTables::NOTATION[top];
+	}
+
+	/**
+	 * @brief The bottom turn written in the range (-8, 9].
+	 */
+	[[nodiscard]] constexpr int bottomNotation() const {
+		return MoveTables::NOTATION[bottom];
+	}
+
+	constexpr bool operator==(const Move &) const = default;
+};
+
+static_assert(sizeof(Move) == 2);
+static_assert(Move::of(-1, 19) == Move{17, 1});
+static_assert(Move::decode(Move{5, 13}.encode()) == Move{5, 13});
+static_assert(Move::of(4, 7).then(Move::of(4, 7).inverse()).isSliceOnly());
+
+/**
+ * @struct MoveSet
+ *
+ * @brief The turn amounts the search may use for each row, as a mask with bit t set for a turn of t.
+ *
+ * The same amounts are allowed for both rows. The common sets are constants,
+ * which the solver recognises and compiles a search for each. See Solver::run()
+ */
+struct MoveSet {
+	uint32_t turns = 0;
+
+	/**
+	 * @brief Builds a set from any turn amounts, wrapping them.
+	 */
+	template<typename Range>
+	static constexpr MoveSet of(const Range &amounts) {
+		MoveSet set;
+		for (const int amount: amounts) {
+			set.turns |= 1u << Move::of(amount, 0).top;
+		}
+		return set;
+	}
+
+	[[nodiscard]] constexpr bool contains(const int turn) const {
+		return (turns >> turn & 1) != 0;
+	}
+
+	constexpr bool operator==(const MoveSet &) const = default;
+
+	// The turns the solver was written for: Every multiple of 3, a turn of one slot either way, and of two slots forward
+	static const MoveSet DEFAULT;
+	// Every rotation of each row
+	static const MoveSet FULL;
+};
+
+inline constexpr MoveSet MoveSet::DEFAULT = of(std::array{0, 3, -3, 6, -6, 9, 1, -1, 2});
+inline constexpr MoveSet MoveSet::FULL = {(1u << MoveTables::TURNS) - 1};
+
+static_assert(MoveSet::DEFAULT.contains(17) && !MoveSet::DEFAULT.contains(16));
+
+/**
+ * @class MoveSequence
+ *
+ * @brief A list of moves stored inline, with a fixed capacity.
+ *
+ * Copying or pushing never allocates, so a search path can live on the stack and be extended and shrunk in place.
+ *
+ * @tparam CAPACITY The most moves the sequence can hold.
+ */
+template<std::size_t CAPACITY>
+class MoveSequence {
+public:
+	static_assert(CAPACITY <= 0xFF, "The length is stored in a byte");
+
+	constexpr MoveSequence() = default;
+
+	/**
+	 * @throws length_error If the sequence is full.
+	 */
+	constexpr void push_back(const Move move) {
+		if (length == CAPACITY) {
+			throw std::length_error("MoveSequence is full.");
+		}
+		moves[length++] = move;
+	}
+
+	constexpr void pop_back() {
+		--length;
+	}
+
+	constexpr void clear() {
+		length = 0;
+	}
+
+	[[nodiscard]] constexpr std::size_t size() const {
+		return length;
+	}
+
+	[[nodiscard]] constexpr bool empty() const {
+		return length == 0;
+	}
+
+	[[nodiscard]] constexpr Move &back() {
+		return moves[length - 1];
+	}
+
+	[[nodiscard]] constexpr Move back() const {
+		return moves[length - 1];
+	}
+
+	constexpr Move &operator[](const std::size_t index) {
+		return moves[index];
+	}
+
+	constexpr Move operator[](const std::size_t index) const {
+		return moves[index];
+	}
+
+	[[nodiscard]] constexpr const Move *begin() const {
+		return moves.data();
+	}
+
+	[[nodiscard]] constexpr const Move *end() const {
+		return moves.data() + length;
+	}
+
+private:
+	std::array<Move, CAPACITY> moves{};
+	uint8_t length = 0;
+};
+
+#endif //MOVE_H
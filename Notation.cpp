@@ -0,0 +1,213 @@
+#include "Notation.h"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include "Cost.h"
+#include "Validation.h"
+
+namespace {
+	Puzzle::Row parseRow(const std::string &hex) {
+		if (hex.empty() || hex.size() > Puzzle::TOTAL_BITS / 4) {
+			throw std::invalid_argument("Row must be 1 to 32 hexadecimal digits: " + hex);
+		}
+
+		Puzzle::Row row = 0;
+		for (const char c: hex) {
+			int digit;
+			if (c >= '0' && c <= '9') {
+				digit = c - '0';
+			} else if (c >= 'a' && c <= 'f') {
+				digit = c - 'a' + 10;
+			} else if (c >= 'A' && c <= 'F') {
+				digit = c - 'A' + 10;
+			} else {
+				throw std::invalid_argument("Invalid hexadecimal digit in row: " + hex);
+			}
+			row = row << 4 | digit;
+		}
+
+		if ((row & ~Puzzle::ROW_MASK) != 0) {
+			throw std::invalid_argument("Row uses bits outside of its 18 slots: " + hex);
+		}
+		return row;
+	}
+
+	std::string formatRow(Puzzle::Row row) {
+		std::string hex;
+		do {
+			hex.insert(hex.begin(), "0123456789abcdef"[static_cast<int>(row & 0xF)]);
+			row >>= 4;
+		} while (row != 0);
+		return hex;
+	}
+}
+
+std::vector<Move> parseMoves(const std::string &text, bool &endsOnSlice) {
+	std::vector<Move> moves;
+	std::istringstream in(text);
+	std::string token;
+	std::vector<int> turns;
+
+	while (in >> token) {
+		if (token == "/") {
+			if (turns.size() == 1) {
+				throw std::invalid_argument("A turn needs both a top and bottom amount: " + text);
+			}
+			moves.push_back(turns.empty() ? Move{} : Move::of(turns[0], turns[1]));
+			turns.clear();
+			continue;
+		}
+
+		if (turns.size() == 2) {
+			throw std::invalid_argument("Expected a slice after each turn: " + text);
+		}
+
+		std::size_t used = 0;
+		int amount = 0;
+		try {
+			amount = std::stoi(token, &used);
+		} catch (const std::logic_error &) {
+			used = 0;
+		}
+		if (used != token.size()) {
+			throw std::invalid_argument("Unexpected token '" + token + "' in scramble: " + text);
+		}
+		turns.push_back(amount);
+	}
+
+	endsOnSlice = turns.empty();
+	if (turns.size() == 1) {
+		throw std::invalid_argument("A turn needs both a top and bottom amount: " + text);
+	}
+	if (!endsOnSlice) {
+		moves.push_back(Move::of(turns[0], turns[1]));
+	}
+	return moves;
+}
+
+Puzzle parseScramble(const std::string &scramble, std::vector<int_fast32_t> &moves, bool &endsOnSlice) {
+	const std::vector<Move> parsed = parseMoves(scramble, endsOnSlice);
+	Puzzle puzzle;
+	for (std::size_t i = 0; i < parsed.size(); ++i) {
+		if (i + 1 < parsed.size() || endsOnSlice) {
+			puzzle.move(moves, parsed[i].top, parsed[i].bottom);
+		} else {
+			puzzle.turn(parsed[i].top, parsed[i].bottom);
+			moves.push_back(parsed[i].encode());
+		}
+	}
+	return puzzle;
+}
+
+std::pair<Puzzle::Row, Puzzle::Row> parseRows(const std::string &text) {
+	const std::size_t colon = text.find(':');
+	if (colon == std::string::npos) {
+		throw std::invalid_argument("Expected two hexadecimal rows separated by a colon: " + text);
+	}
+	return {parseRow(text.substr(0, colon)), parseRow(text.substr(colon + 1))};
+}
+
+Puzzle parsePuzzle(const std::string &text) {
+	if (text.find(':') != std::string::npos) {
+		const auto [top, bottom] = parseRows(text);
+		const Puzzle puzzle(top, bottom);
+		validateState(puzzle);
+		return puzzle;
+	}
+
+	std::vector<int_fast32_t> moves;
+	bool endsOnSlice;
+	return parseScramble(text, moves, endsOnSlice);
+}
+
+MoveSet parseMoveSet(const std::string &text) {
+	if (text == "default") {
+		return MoveSet::DEFAULT;
+	}
+	if (text == "full") {
+		return MoveSet::FULL;
+	}
+
+	std::vector<int> amounts;
+	std::istringstream in(text);
+	std::string token;
+	while (std::getline(in, token, ',')) {
+		std::size_t used = 0;
+		try {
+			amounts.push_back(std::stoi(token, &used));
+		} catch (const std::logic_error &) {
+			used = 0;
+		}
+		if (used == 0 || used != token.size()) {
+			throw std::invalid_argument("Unexpected turn '" + token + "' in move set: " + text);
+		}
+	}
+
+	const MoveSet set = MoveSet::of(amounts);
+	if (set.turns == 0) {
+		throw std::invalid_argument("A move set needs at least one turn: " + text);
+	}
+	return set;
+}
+
+CostModel parseCostModel(const std::string &text) {
+	if (text == "slice") {
+		return CostModel::slice();
+	}
+	if (text == "twist") {
+		return CostModel::twist();
+	}
+
+	const std::string prefix = "weights:";
+	if (text.rfind(prefix, 0) != 0) {
+		throw std::invalid_argument("Unknown cost model: " + text);
+	}
+	std::vector<uint16_t> weights;
+	std::istringstream in(text.substr(prefix.size()));
+	std::string token;
+	while (std::getline(in, token, ',')) {
+		std::size_t used = 0;
+		int weight = -1;
+		try {
+			weight = std::stoi(token, &used);
+		} catch (const std::logic_error &) {
+			used = 0;
+		}
+		if (used == 0 || used != token.size() || weight < 0 || weight > 0xFFFF) {
+			throw std::invalid_argument("Unexpected weight '" + token + "' in cost model: " + text);
+		}
+		weights.push_back(static_cast<uint16_t>(weight));
+	}
+	if (weights.size() != CostModel::MOST_TURN + 2) {
+		throw std::invalid_argument("Expected a weight per move, per slice, and per turn of 1 to " +
+		                            std::to_string(CostModel::MOST_TURN) + ": " + text);
+	}
+
+	CostModel model{weights[0], weights[1], {}};
+	std::copy(weights.begin() + 2, weights.end(), model.perTurn.begin() + 1);
+	return model;
+}
+
+std::string formatScramble(const std::vector<int_fast32_t> &moves, const bool endsOnSlice) {
+	std::ostringstream out;
+	for (std::size_t i = 0; i < moves.size(); ++i) {
+		const auto [topTurns, bottomTurns] = Puzzle::decodeMove(moves[i]);
+		if (i > 0) {
+			out << ' ';
+		}
+		if (topTurns != 0 || bottomTurns != 0 || (i + 1 == moves.size() && !endsOnSlice)) {
+			out << Puzzle::wrapNegative(topTurns) << ' ' << Puzzle::wrapNegative(bottomTurns);
+			if (i + 1 < moves.size() || endsOnSlice) {
+				out << ' ';
+			}
+		}
+		if (i + 1 < moves.size() || endsOnSlice) {
+			out << '/';
+		}
+	}
+	return out.str();
+}
+
+std::string formatState(const Puzzle &puzzle) {
+	return formatRow(puzzle.getTop()) + ":" + formatRow(puzzle.getBottom());
+}
@@ -0,0 +1,91 @@
+#ifndef NOTATION_H
+#define NOTATION_H
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Move.h"
+#include "Puzzle.h"
+
+struct CostModel;
+
+/**
+ * @file Notation.h
+ *
+ * @brief Reading and writing puzzle states from the command line.
+ *
+ * Two formats are accepted:
+ *
+ *   Scramble: Turns and slices as printed in solutions, applied to a solved puzzle.
+ *             "3 0 / -3 -3 / 0 3 /" turns the top by 3 then slices, and so on.
+ *             A "/" on its own is a slice without a turn, and a scramble may end on a turn.
+ *
+ *   State:    The two encoded rows in hexadecimal, top first, separated by a colon.
+ *             "510834c41551875c825928b6cc:9a5d648f38a1c6cafbaa9e689f7" is the solved state.
+ *
+ * ──────────────────────────────────────────────────────────────────────────────────────────────────
+ */
+
+/**
+ * @brief Applies a scramble to a solved puzzle, recording each move.
+ *
+ * @param scramble The scramble in solution notation.
+ * @param moves The list each turn and slice is recorded to.
+ * @param endsOnSlice Set to FALSE if the scramble ends on a turn, in which case the last move recorded has no slice.
+ * @return The scrambled puzzle.
+ *
+ * @throws invalid_argument If the scramble is malformed.
+ * @throws logic_error If the scramble slices while a corner is in the way.
+ */
+Puzzle parseScramble(const std::string &scramble, std::vector<int_fast32_t> &moves, bool &endsOnSlice);
+
+/**
+ * @brief Reads moves in solution notation without applying them, as for solutions of other states.
+ *
+ * @param endsOnSlice Set to FALSE if the text ends on a turn, in which case the last move has no slice.
+ * @throws invalid_argument If the text is malformed.
+ */
+std::vector<Move> parseMoves(const std::string &text, bool &endsOnSlice);
+
+/**
+ * @brief Parses two rows in the hexadecimal state format, without checking that they form a state, as for masks.
+ *
+ * @throws invalid_argument If the text is malformed.
+ */
+std::pair<Puzzle::Row, Puzzle::Row> parseRows(const std::string &text);
+
+/**
+ * @brief Parses either a hexadecimal state or a scramble. See file notes.
+ *
+ * @throws invalid_argument If neither format matches, or the state cannot be reached. See Validation.h
+ */
+Puzzle parsePuzzle(const std::string &text);
+
+/**
+ * @brief Parses the turn amounts a search may use.
+ *
+ * Either "default", "full", or a comma separated list of turn amounts such as "0,3,-3,6".
+ *
+ * @throws invalid_argument If the text is malformed or allows no turns.
+ */
+MoveSet parseMoveSet(const std::string &text);
+
+/**
+ * @brief Parses a cost model: "slice", "twist", or "weights:" followed by the comma separated weights per move,
+ * per slice, and per turn of 1 to 9 slots either way. See Cost.h
+ *
+ * @throws invalid_argument If the text is malformed.
+ */
+CostModel parseCostModel(const std::string &text);
+
+/**
+ * @brief Formats moves as a scramble, exactly as given, the inverse of parseScramble().
+ */
+std::string formatScramble(const std::vector<int_fast32_t> &moves, bool endsOnSlice);
+
+/**
+ * @brief Formats a puzzle as a hexadecimal state, the inverse of parsePuzzle().
+ */
+std::string formatState(const Puzzle &puzzle);
+
+#endif //NOTATION_H
@@ -0,0 +1,136 @@
+#include "Perft.h"
+#include <array>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include "Solver.h"
+#include "Symmetry.h"
+
+namespace {
+	/**
+	 * Maps every state seen to the shallowest depth it was reached at.
+	 * Split into independently locked shards so that tasks rarely wait on each other.
+	 */
+	class SeenStates {
+	public:
+		explicit SeenStates(const bool symmetric) : symmetric(symmetric) {
+		}
+
+		void record(const Puzzle &state, const int depth) {
+			const Puzzle puzzle = symmetric ? Symmetry::canonicalize(state).puzzle : state;
+			const uint64_t hash = puzzle.hash();
+			Shard &shard = shards[hash >> (64 - SHARD_BITS)];
+			std::lock_guard lock(shard.mutexLock);
+			auto [it, inserted] = shard.depths.try_emplace(puzzle, depth);
+			if (!inserted && depth < it->second) {
+				it->second = depth;
+			}
+		}
+
+		void histogram(std::vector<uint64_t> &distinct) {
+			for (auto &shard: shards) {
+				for (const auto &[puzzle, depth]: shard.depths) {
+					++distinct[depth];
+				}
+			}
+		}
+
+	private:
+		static constexpr int SHARD_BITS = 6;
+
+		struct Shard {
+			std::mutex mutexLock;
+			std::unordered_map<Puzzle, int, PuzzleHash> depths;
+		};
+
+		bool symmetric;
+		std::array<Shard, 1 << SHARD_BITS> shards;
+	};
+
+	void count(const Puzzle &puzzle, const int depth, const int maxDepth, std::vector<uint64_t> &sequences,
+	           SeenStates *seen) {
+		++sequences[depth];
+		if (seen != nullptr) {
+			seen->record(puzzle, depth);
+		}
+		if (depth >= maxDepth) {
+			return;
+		}
+
+		for (int_fast32_t a = 0; a < SIZE_OF_MOVES; ++a) {
+			// Turns which can't be sliced are rejected before turning. See Puzzle::canSliceTopAfter()
+			if (!puzzle.canSliceTopAfter(Puzzle::wrapPositive(MOVES[a]))) {
+				continue;
+			}
+			Puzzle topNext = puzzle.clone();
+			topNext.turn(MOVES[a], 0);
+
+			for (int_fast32_t b = 0; b < SIZE_OF_MOVES; ++b) {
+				if (!topNext.canSliceBottomAfter(Puzzle::wrapPositive(MOVES[b]))) {
+					continue;
+				}
+				Puzzle bottomNext = topNext.clone();
+				bottomNext.turn(0, MOVES[b]);
+
+				bottomNext.slice();
+				count(bottomNext, depth + 1, maxDepth, sequences, seen);
+			}
+		}
+	}
+}
+
+Perft::Result Perft::run(const Puzzle &start, const int depth, const bool distinct, const bool symmetric) {
+	if (depth < 0) {
+		throw std::invalid_argument("The depth must not be negative.");
+	}
+	Result result{std::vector<uint64_t>(depth + 1), std::vector<uint64_t>(depth + 1)};
+	SeenStates seen(symmetric);
+	SeenStates *seenStates = distinct ? &seen : nullptr;
+
+	result.sequences[0] = 1;
+	if (distinct) {
+		seen.record(start, 0);
+	}
+
+	std::vector<std::future<std::vector<uint64_t> > > futures;
+	if (depth > 0) {
+		for (int_fast32_t a = 0; a < SIZE_OF_MOVES; ++a) {
+			Puzzle topNext = start.clone();
+			topNext.turn(MOVES[a], 0);
+
+			if (!topNext.canSliceTop()) {
+				continue;
+			}
+
+			futures.emplace_back(std::async(std::launch::async, [topNext, depth, seenStates]() {
+				std::vector<uint64_t> sequences(depth + 1);
+				for (int_fast32_t b = 0; b < SIZE_OF_MOVES; ++b) {
+					Puzzle bottomNext = topNext.clone();
+					bottomNext.turn(0, MOVES[b]);
+
+					if (!bottomNext.canSliceBottom()) {
+						continue;
+					}
+
+					bottomNext.slice();
+					count(bottomNext, 1, depth, sequences, seenStates);
+				}
+				return sequences;
+			}));
+		}
+	}
+
+	for (auto &fut: futures) {
+		const std::vector<uint64_t> sequences = fut.get();
+		for (int d = 1; d <= depth; ++d) {
+			result.sequences[d] += sequences[d];
+		}
+	}
+
+	if (distinct) {
+		std::fill(result.distinct.begin(), result.distinct.end(), 0);
+		seen.histogram(result.distinct);
+	}
+	return result;
+}
@@ -0,0 +1,41 @@
+#ifndef PERFT_H
+#define PERFT_H
+#include <cstdint>
+#include <vector>
+#include "Puzzle.h"
+
+/**
+ * @class Perft
+ *
+ * @brief Counts move sequences from a state, in the style of a chess engine's perft.
+ *
+ * A move is a turn of each row by an amount in MOVES that leaves both rows sliceable, followed by the slice.
+ * The counts only depend on the move generator, so they are a reproducible throughput benchmark
+ * and a correctness oracle for any optimized generator: Both must report identical numbers.
+ */
+class Perft {
+public:
+	struct Result {
+		// sequences[d] is the number of legal move sequences of exactly d moves
+		std::vector<uint64_t> sequences;
+		// distinct[d] is the number of states, or symmetry classes of states, first reached after exactly d moves
+		// (Only filled if requested)
+		std::vector<uint64_t> distinct;
+	};
+
+	/**
+	 * @brief Counts every move sequence up to a depth, with one task per top turn of the first move.
+	 *
+	 * @param start The state to count from.
+	 * @param depth The number of moves to count up to.
+	 * @param distinct Whether to also count distinct states, by hashing every state reached.
+	 * @param symmetric Whether states in the same symmetry class count once, storing only canonical states.
+	 *                  See Symmetry.h
+	 * @return The counts for every depth from 0 to `depth`.
+	 *
+	 * @throws invalid_argument If the depth is negative.
+	 */
+	static Result run(const Puzzle &start, int depth, bool distinct, bool symmetric = false);
+};
+
+#endif //PERFT_H
@@ -0,0 +1,140 @@
+#ifndef PIECE_INDEX_H
+#define PIECE_INDEX_H
+#include <array>
+#include <cstdint>
+#include "Puzzle.h"
+
+/**
+ * @class PieceIndex
+ *
+ * @brief Where each piece of a puzzle is, kept up to date alongside it so that finding a piece needs no scan.
+ *
+ * A piece is named by its whole slot value (See Binary Slot Format), which is unique in the puzzle: its Piece ID
+ * together with its face and which half of a corner it is.
+ *
+ * Each row is stored as it was last sliced, with a count of how far it has turned since. A turn only adds to that
+ * offset, and a lookup subtracts it, so both are O(1). A slice swaps the halves of the rows, which moves 18 pieces
+ * between them, and re-homes each of them.
+ *
+ * The index doesn't check moves itself. Apply each change to the puzzle first, which throws for a blocked slice,
+ * then to the index. MacroTable follows slots through a macro with one, and `HexagonOneSolver index` checks it against
+ * a fresh index after every change of random move sequences.
+ */
+class PieceIndex {
+public:
+	// One past the largest slot value
+	static constexpr int PIECES = 1 << Puzzle::SLOT_SIZE;
+
+	struct Location {
+		// 0 for the top row, 1 for the bottom
+		uint8_t row;
+		// The slot within the row, as Puzzle numbers them from the lowest bits
+		uint8_t slot;
+
+		constexpr bool operator==(const Location &) const = default;
+	};
+
+	/**
+	 * @brief Indexes every piece of a puzzle, scanning it once.
+	 */
+	constexpr explicit PieceIndex(const Puzzle &puzzle) {
+		const Puzzle::Row rows[] = {puzzle.getTop(), puzzle.getBottom()};
+		for (uint8_t row = 0; row < 2; ++row) {
+			for (uint8_t slot = 0; slot < SLOTS; ++slot) {
+				const auto piece = static_cast<uint8_t>(rows[row] >> (slot * Puzzle::SLOT_SIZE) & Puzzle::SLOT_MASK);
+				occupants[row][slot] = piece;
+				homes[piece] = {row, slot};
+			}
+		}
+	}
+
+	/**
+	 * @brief Follows Puzzle::turn().
+	 */
+	constexpr void turn(const int topTurns, const int bottomTurns) {
+		offsets[0] = static_cast<uint8_t>((offsets[0] + Puzzle::wrapPositive(topTurns)) % SLOTS);
+		offsets[1] = static_cast<uint8_t>((offsets[1] + Puzzle::wrapPositive(bottomTurns)) % SLOTS);
+	}
+
+	/**
+	 * @brief Follows Puzzle::slice(), which must have succeeded.
+	 */
+	constexpr void slice() {
+		for (int slot = Puzzle::SLOTS_PER_HALF; slot < SLOTS; ++slot) {
+			const auto top = static_cast<uint8_t>((slot + offsets[0]) % SLOTS);
+			const auto bottom = static_cast<uint8_t>((slot + offsets[1]) % SLOTS);
+			const uint8_t toBottom = occupants[0][top];
+			occupants[0][top] = occupants[1][bottom];
+			occupants[1][bottom] = toBottom;
+			homes[occupants[0][top]] = {0, top};
+			homes[toBottom] = {1, bottom};
+		}
+	}
+
+	/**
+	 * @brief Follows Puzzle::move().
+	 */
+	constexpr void move(const int topTurns, const int bottomTurns) {
+		turn(topTurns, bottomTurns);
+		slice();
+	}
+
+	/**
+	 * @brief Where a piece is. Only meaningful for a value the puzzle holds.
+	 */
+	[[nodiscard]] constexpr Location locate(const uint8_t piece) const {
+		const Location home = homes[piece & Puzzle::SLOT_MASK];
+		return {home.row, static_cast<uint8_t>((home.slot + SLOTS - offsets[home.row]) % SLOTS)};
+	}
+
+	/**
+	 * @brief The piece in a slot, the inverse of locate().
+	 */
+	[[nodiscard]] constexpr uint8_t pieceAt(const int row, const int slot) const {
+		return occupants[row][(slot + offsets[row]) % SLOTS];
+	}
+
+	/**
+	 * @brief Whether two indexes place every piece alike, however differently their rows were stored.
+	 */
+	[[nodiscard]] constexpr bool operator==(const PieceIndex &other) const {
+		for (int row = 0; row < 2; ++row) {
+			for (int slot = 0; slot < SLOTS; ++slot) {
+				const uint8_t piece = pieceAt(row, slot);
+				if (other.pieceAt(row, slot) != piece || !(other.locate(piece) == locate(piece))) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+private:
+	static constexpr int SLOTS = Puzzle::SLOTS_PER_ROW;
+
+	// homes[piece] is its slot when its row was last sliced
+	std::array<Location, PIECES> homes{};
+	// occupants[row][slot] is the piece there when the row was last sliced
+	std::array<std::array<uint8_t, SLOTS>, 2> occupants{};
+	// How far each row has turned since
+	std::array<uint8_t, 2> offsets{};
+};
+
+// Self-check, evaluated by the compiler: after some moves, the index agrees with indexing the puzzle afresh
+static_assert([] {
+	Puzzle puzzle;
+	PieceIndex index(puzzle);
+	for (const auto &[topTurns, bottomTurns]: {std::pair{3, -3}, {0, 3}, {-3, 0}, {1, 6}, {2, -1}}) {
+		Puzzle next = puzzle.clone();
+		next.turn(topTurns, bottomTurns);
+		index.turn(topTurns, bottomTurns);
+		if (next.canSlice()) {
+			next.slice();
+			index.slice();
+		}
+		puzzle = next;
+	}
+	return index == PieceIndex(puzzle);
+}());
+
+#endif //PIECE_INDEX_H
@@ -0,0 +1,92 @@
+#include "Portfolio.h"
+#include <atomic>
+#include <future>
+#include <mutex>
+#include "BestFirst.h"
+#include "Bidirectional.h"
+
+namespace {
+	/**
+	 * Collects the first result and cancels every engine still running.
+	 */
+	class Race {
+	public:
+		std::atomic<bool> finished = false;
+
+		void offer(Portfolio::Result result) {
+			std::lock_guard lock(mutexLock);
+			if (!winner) {
+				winner = std::move(result);
+				finished.store(true, std::memory_order_relaxed);
+			}
+		}
+
+		std::optional<Portfolio::Result> take() {
+			std::lock_guard lock(mutexLock);
+			return std::move(winner);
+		}
+
+	private:
+		std::mutex mutexLock;
+		std::optional<Portfolio::Result> winner;
+	};
+}
+
+Portfolio::Portfolio(const int limit, const MoveSet moveSet, const Goal goal) : limit(limit), moveSet(moveSet),
+	goal(goal) {
+}
+
+std::optional<Portfolio::Result> Portfolio::solve(const Puzzle &start) const {
+	Race race;
+	std::vector<std::future<void> > engines;
+
+	// Searches with a Solver, offering the first solution it reports
+	auto solverEngine = [this, &race, start](std::string name, const bool optimal, const bool ordered = false) {
+		return std::async(std::launch::async, [this, &race, name = std::move(name), start, optimal, ordered]() {
+			std::optional<Result> found;
+			Solver solver([&found](const Solver<>::Path &path, const bool endsOnSlice) {
+				found = Result{"", std::vector<Move>(path.begin(), path.end()), endsOnSlice};
+				return true;
+			}, limit, moveSet, goal);
+			solver.setCancellation(&race.finished);
+			solver.setOrdering(ordered);
+
+			if (optimal) {
+				solver.solveOptimal(start, limit, false);
+			} else {
+				solver.solve(start);
+			}
+			if (found) {
+				found->engine = name;
+				race.offer(std::move(*found));
+			}
+		});
+	};
+
+	engines.push_back(solverEngine("IDA*", true));
+	engines.push_back(solverEngine("DFS", false));
+	if (goal != Goal::TOP_LAYER && goal != Goal::BOTTOM_LAYER) {
+		engines.push_back(solverEngine("Ordered DFS", false, true));
+	}
+
+	engines.push_back(std::async(std::launch::async, [this, &race, start]() {
+		BestFirst search(limit, moveSet, goal);
+		if (std::optional<BestFirst::Result> found = search.solve(start, race.finished)) {
+			race.offer({"A*", std::move(found->moves), found->endsOnSlice});
+		}
+	}));
+
+	if (goal == Goal::SOLVED) {
+		engines.push_back(std::async(std::launch::async, [this, &race, start]() {
+			const Bidirectional search(limit, moveSet);
+			if (std::optional<Bidirectional::Result> found = search.solve(start, race.finished)) {
+				race.offer({"Bidirectional", std::move(found->moves), found->endsOnSlice});
+			}
+		}));
+	}
+
+	for (auto &engine: engines) {
+		engine.get();
+	}
+	return race.take();
+}
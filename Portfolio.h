@@ -0,0 +1,57 @@
+#ifndef PORTFOLIO_H
+#define PORTFOLIO_H
+#include <optional>
+#include <string>
+#include <vector>
+#include "Move.h"
+#include "Puzzle.h"
+#include "Solver.h"
+
+/**
+ * @class Portfolio
+ *
+ * @brief Races several search strategies on the same state, taking whichever finishes first.
+ *
+ * No single strategy is fastest on every state, so racing them trims the slow cases. Engines:
+ *
+ *   IDA*:          Solver::solveOptimal(), one depth at a time, which finds a shortest solution.
+ *   DFS:           Solver::solve() straight to the limit, which can find a longer solution much sooner.
+ *   Ordered DFS:   DFS trying the most promising moves first, which finds its first solution on a different
+ *                  path, so it is fast on different states. Not for the goals which solve a layer. See Solver::setOrdering()
+ *   A*:            Best-first within a memory cap, which expands each state once, so it is fast where many move
+ *                  orders reach the same states. Gives up if memory runs out. See BestFirst.h
+ *   Bidirectional: Searches from both ends until they meet. Only for Goal::SOLVED. See Bidirectional.h
+ *
+ * Each engine runs as its own task. The first to finish sets a shared token which every other engine checks
+ * between nodes, so the losers stop cooperatively and solve() returns once they have.
+ */
+class Portfolio {
+public:
+	struct Result {
+		// The name of the engine which finished first
+		std::string engine;
+		std::vector<Move> moves;
+		// Whether the last move includes its slice
+		bool endsOnSlice = true;
+	};
+
+	/**
+	 * @param limit The most moves in a solution.
+	 * @param moveSet The turn amounts tried for each row.
+	 * @param goal The states counted as solutions.
+	 */
+	Portfolio(int limit, MoveSet moveSet, Goal goal);
+
+	/**
+	 * @param start The state to solve.
+	 * @return The first solution found, or nothing if no engine found one within the limit.
+	 */
+	[[nodiscard]] std::optional<Result> solve(const Puzzle &start) const;
+
+private:
+	int limit;
+	MoveSet moveSet;
+	Goal goal;
+};
+
+#endif //PORTFOLIO_H
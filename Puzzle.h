@@ -1,6 +1,9 @@
 #ifndef PUZZLE_H
 #define PUZZLE_H
+#include <array>
 #include <cstdint>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
 /**
@@ -12,6 +15,9 @@
  * This is a compressed int of 18 contiguous slots containing 6 bits per slot.
  * Each 6-bit slot encodes exactly one uniquely identifiable piece, along with relevant information. (See Binary Slot Format).
  *
+ * Everything the search calls per node is constexpr and defined here, so it inlines into every caller,
+ * and the tables built from it are computed at compile time. Only printing lives in Puzzle.cpp.
+ *
  * ──────────────────────────────────────────────────────────────────────────────────────────────────
  *
  * Binary Slot Format
@@ -154,12 +160,33 @@ private:
 	 *   - Output:  row = [E5, C6, E6, C1, E1, ..., C5]
 	 *
 	 */
-	static Row turnRow(Row row, int slots);
+	static constexpr Row turnRow(const Row row, const int slots) {
+		if (slots == 0)
+			return row;
+		// Normalizes to [0, 18) and multiplies that by 6 to get the number of bits over it's shifting.
+		const int shift = wrapPositive(slots) * SLOT_SIZE;
+		if (shift == 0)
+			return row;
+		// Bitshift to the left end except for the last number of slots to clear the beginning bits
+		// Then bitshift back to the right 20 bits to move it to the start of the row
+		const Row tail = (row << (TOTAL_BITS - shift)) >> (TOTAL_BITS - ROW_BITS);
+		// Shift the row to the right, and reapply the missing bits
+		Row next = (row >> shift) | tail;
+		// Make sure nothing is in the unused space
+		next &= ROW_MASK;
+		return next;
+	}
+
+	// SLICE_AFTER_TURN[t] is SLICE_MASK turned back by t, so a row can be sliced after a turn of t exactly when it
+	// has none of its bits set. See canSliceTopAfter()
+	static const std::array<Row, SLOTS_PER_ROW> SLICE_AFTER_TURN;
 
 public:
-	Puzzle();
+	constexpr Puzzle() : top(SOLVED_TOP), bottom(SOLVED_BOTTOM) {
+	}
 
-	Puzzle(Row, Row);
+	constexpr Puzzle(const Row topRow, const Row bottomRow) : top(topRow), bottom(bottomRow) {
+	}
 
 	/**
 	 * @brief Wraps a number of turns to the range [0, 18)
@@ -167,7 +194,9 @@ public:
 	 * @param turns the number of turns to wrap
 	 * @return a number wrapped to the range [0, 18)
 	 */
-	static int wrapPositive(int turns);
+	static constexpr int wrapPositive(const int turns) {
+		return ((turns % SLOTS_PER_ROW + SLOTS_PER_ROW) % SLOTS_PER_ROW);
+	}
 
 	/**
 	 * @brief Wraps a number of turns to the range (-8, 9]
@@ -175,7 +204,9 @@ public:
 	 * @param turns the number of turns to wrap
 	 * @return a number wrapped to the range (-8, 9]
 	 */
-	static int wrapNegative(int turns);
+	static constexpr int wrapNegative(const int turns) {
+		return ((wrapPositive(turns) + SLOTS_PER_HALF - 1) % SLOTS_PER_ROW - (SLOTS_PER_HALF - 1));
+	}
 
 	/**
 	 *
@@ -185,7 +216,9 @@ public:
 	 * @param bottomTurns the number of bottom turns
 	 * @return an encoded integer
 	 */
-	static int_fast32_t encodeMove(int_fast32_t topTurns, int_fast32_t bottomTurns);
+	static constexpr int_fast32_t encodeMove(const int_fast32_t topTurns, const int_fast32_t bottomTurns) {
+		return (wrapPositive(topTurns) << SLOT_SIZE) | wrapPositive(bottomTurns);
+	}
 
 	/**
 	 *
@@ -194,7 +227,9 @@ public:
 	 * @param move encoded move to decode
 	 * @return two integers for the top and bottom moves
 	 */
-	static std::pair<int_fast32_t, int_fast32_t> decodeMove(int_fast32_t move);
+	static constexpr std::pair<int_fast32_t, int_fast32_t> decodeMove(const int_fast32_t move) {
+		return std::make_pair((move >> SLOT_SIZE) & ((1 << SLOT_SIZE) - 1), move & ((1 << SLOT_SIZE) - 1));
+	}
 
 	/**
 	 *
@@ -209,7 +244,10 @@ public:
 	 *   - topTurns = 2: top row is rotated 2 slots clockwise.
 	 *   - bottomTurns = -1: bottom row is rotated 1 slot counterclockwise.
 	 */
-	void turn(int topTurns, int bottomTurns);
+	constexpr void turn(const int topTurns, const int bottomTurns) {
+		top = turnRow(top, topTurns);
+		bottom = turnRow(bottom, bottomTurns);
+	}
 
 	/**
 	 * @brief Performs a turn followed by a slice move on the puzzle, recording it to a list.
@@ -217,7 +255,10 @@ public:
 	 * Mainly for convenience.
 	 *
 	 */
-	void move(std::vector<int_fast32_t> &moves, int topTurns, int bottomTurns);
+	void move(std::vector<int_fast32_t> &moves, const int topTurns, const int bottomTurns) {
+		move(topTurns, bottomTurns);
+		moves.push_back(encodeMove(topTurns, bottomTurns));
+	}
 
 	/**
 	 * @brief Performs a turn followed by a slice move on the puzzle.
@@ -225,7 +266,10 @@ public:
 	 * Mainly for convenience.
 	 *
 	 */
-	void move(int topTurns, int bottomTurns);
+	constexpr void move(const int topTurns, const int bottomTurns) {
+		turn(topTurns, bottomTurns);
+		slice();
+	}
 
 	/**
 	 * @brief Performs a slice move on the puzzle.
@@ -234,7 +278,22 @@ public:
 	 *
 	 * @throws logic_error Cannot perform a slice operation if a slice move is currently unavailable.
 	 */
-	void slice();
+	constexpr void slice() {
+		if (!canSlice()) {
+			throw std::logic_error("Cannot perform a slice operation if a slice move is currently unavailable.");
+		}
+
+		/**
+		 * HALF_MASK is a binary number with a 1 for the entire left half of the puzzle.
+		 * 00000000000000000000 111111111111111111111111111111111111111111111111111111 000000000000000000000000000000000000000000000000000000
+		 * And is used to isolate each half before swapping.
+		 */
+		const Row topHalf = top & HALF_MASK;
+		const Row bottomHalf = bottom & HALF_MASK;
+
+		top = top & ~HALF_MASK | bottomHalf;
+		bottom = bottom & ~HALF_MASK | topHalf;
+	}
 
 	/**
 	 * @brief Checks if the puzzle is in cube shape.
@@ -244,7 +303,17 @@ public:
 	 *
 	 * @return TRUE if both the top and bottom rows are in proper cube shape.
 	 */
-	[[nodiscard]] bool cubeShape() const;
+	[[nodiscard]] constexpr bool cubeShape() const {
+		/** TOP_CUBE_SHAPE and BOTTOM_CUBE_SHAPE are binary numbers with a 1 in each slot where an edge should be.
+		* 00000000000000000000 000000000000 000001 000000000000 000001 000000000000 000001 000000000000 000001 000000000000 000001 000000000000 000001
+		* 00000000000000000000 000001 000000000000 000001 000000000000 000001 000000000000 000001 000000000000 000001 000000000000 000001 000000000000
+		* As there are exactly 12 edges, checking if exactly 12 slots are edges should never let an extra edge slip by.
+		* And checking that they're in the right order, it is impossible for anything other than a corner to be in the remaning locations.
+		* Assuming no illegal moves have been performed, this implies cube shape.
+		* Small note; These need to be two different numbers as the bottom row is in reverse order.
+		*/
+		return (top & TOP_CUBE_SHAPE) == 0 && (bottom & BOTTOM_CUBE_SHAPE) == 0;
+	}
 
 	/**
 	* @brief Checks if a slice move is currently allowed.
@@ -253,25 +322,67 @@ public:
 	 *
 	 * @return TRUE if both layers are allowed to be sliced.
 	 */
-	[[nodiscard]] bool canSlice() const;
+	[[nodiscard]] constexpr bool canSlice() const {
+		/**
+		 * SLICE_MASK is a binary number with a 1 in the Corner Parity bit for the slots in location 0 and 8
+		 * 00000000000000000000 010000 000000000000000000000000000000000000000000000000 010000 000000000000000000000000000000000000000000000000
+		 * Assuming no illegal moves have been performed, the left and right halves of a corner will always stay together.
+		 * Therefor, we can know if a corner is between the slice axis by checking if the right half of the corner is on the right of the slice
+		 * which correspond to slots 0 and 8.
+		 */
+		return (top & SLICE_MASK) == 0 && (bottom & SLICE_MASK) == 0;
+	}
 
 	/**
 	 * @brief Checks if the top row can be sliced.
 	 * @return TRUE if the top layer can be sliced.
 	 */
-	[[nodiscard]] bool canSliceTop() const;
+	[[nodiscard]] constexpr bool canSliceTop() const {
+		// See canSlice for details
+		return (top & SLICE_MASK) == 0;
+	}
 
 	/**
 	 * @brief Checks if the bottom row can be sliced.
 	 * @return TRUE if the bottom layer can be sliced.
 	 */
-	[[nodiscard]] bool canSliceBottom() const;
+	[[nodiscard]] constexpr bool canSliceBottom() const {
+		// See canSlice for details
+		return (bottom & SLICE_MASK) == 0;
+	}
+
+	/**
+	 * @brief Checks if the top row could be sliced after turning it, without turning it.
+	 * @param turns The turn, wrapped to [0, 18).
+	 * @return TRUE if the top layer can be sliced after the turn.
+	 */
+	[[nodiscard]] constexpr bool canSliceTopAfter(const int turns) const {
+		return (top & SLICE_AFTER_TURN[turns]) == 0;
+	}
+
+	/**
+	 * @brief Checks if the bottom row could be sliced after turning it, without turning it.
+	 * @param turns The turn, wrapped to [0, 18).
+	 * @return TRUE if the bottom layer can be sliced after the turn.
+	 */
+	[[nodiscard]] constexpr bool canSliceBottomAfter(const int turns) const {
+		return (bottom & SLICE_AFTER_TURN[turns]) == 0;
+	}
 
 	/**
 	 * @brief Checks if all the top and bottom pieces are in the correct row.
 	 * @return TRUE if all the top pieces are in the top row, and all the bottom pieces are in the bottom row.
 	 */
-	[[nodiscard]] bool isRowOrientationSolved() const;
+	[[nodiscard]] constexpr bool isRowOrientationSolved() const {
+		/**
+		 * ROW_ORIENTATION_MASK is a binary number with 1's in every Face Parity bit for each slot.
+		 * 00000000000000000000 100000 100000 100000 100000 100000 100000 100000 100000 100000 100000 100000 100000 100000 100000 100000 100000 100000 100000
+		 * This checks if all of the face parity bits are zero, indicating they're top pieces
+		 * Then does the same to the bottom by inverting it first, which turns what would be 1's in those bits to 0's.
+		 * If there are any pieces in the wrong row, it will be picked up by this mask.
+		 */
+		return (top & ROW_ORIENTATION_MASK) == 0 && (~bottom & ROW_ORIENTATION_MASK) == 0;
+	}
 
 	/**
 	 * @brief Checks if the puzzle matches a specific layout.
@@ -285,31 +396,84 @@ public:
 	 *
 	 * @return TRUE if the top row and bottom rows match where required.
 	 */
-	[[nodiscard]] bool isSolvedByMatches(Row topMatch, Row topMask, Row bottomMatch, Row bottomMask) const;
+	[[nodiscard]] constexpr bool isSolvedByMatches(const Row topMatch, const Row topMask, const Row bottomMatch,
+	                                               const Row bottomMask) const {
+		if (!cubeShape()) {
+			return false;
+		}
+
+		if (!isRowOrientationSolved()) {
+			return false;
+		}
+
+		return (top & topMask) == (topMatch & topMask) && (bottom & bottomMask) == (bottomMatch & bottomMask);
+	}
 
 	/**
 	 * @brief Checks if the puzzle is solved.
 	 * @return TRUE if the top and bottom rows match the solved state.
 	 */
-	[[nodiscard]] bool isSolved() const;
+	[[nodiscard]] constexpr bool isSolved() const {
+		return top == SOLVED_TOP && bottom == SOLVED_BOTTOM;
+	}
 
 	/**
 	 * @brief Checks if the top row is solved.
 	 * @return TRUE if the top row matches the solved state.
 	 */
-	[[nodiscard]] bool isTopSolved() const;
+	[[nodiscard]] constexpr bool isTopSolved() const {
+		return top == SOLVED_TOP;
+	}
 
 	/**
 	 * @brief Checks if the bottom row is solved.
 	 * @return TRUE if the bottom row matches the solved state.
 	 */
-	[[nodiscard]] bool isBottomSolved() const;
+	[[nodiscard]] constexpr bool isBottomSolved() const {
+		return bottom == SOLVED_BOTTOM;
+	}
 
 	/**
 	 * @brief Clones the puzzle
 	 * @return A true clone
 	 */
-	[[nodiscard]] Puzzle clone() const;
+	[[nodiscard]] constexpr Puzzle clone() const {
+		return {top, bottom};
+	}
+
+	/**
+	 * @brief Gets the encoded top row.
+	 */
+	[[nodiscard]] constexpr Row getTop() const {
+		return top;
+	}
+
+	/**
+	 * @brief Gets the encoded bottom row.
+	 */
+	[[nodiscard]] constexpr Row getBottom() const {
+		return bottom;
+	}
+
+	/**
+	 * @brief Hashes both rows into 64 bits.
+	 *
+	 * Every bit of both rows affects every bit of the result, so the low bits can be used directly for bucketing.
+	 */
+	[[nodiscard]] constexpr uint64_t hash() const {
+		// SplitMix64 finalizer over each 64-bit word, chained so that the order of the words matters.
+		auto mix = [](uint64_t x) {
+			x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+			return x ^ (x >> 31);
+		};
+		uint64_t h = mix(static_cast<uint64_t>(top));
+		h = mix(h ^ static_cast<uint64_t>(top >> 64));
+		h = mix(h ^ static_cast<uint64_t>(bottom));
+		return mix(h ^ static_cast<uint64_t>(bottom >> 64));
+	}
+
+	constexpr bool operator==(const Puzzle &) const = default;
 
 	/**
 	 * @brief Prints a row in its binary slot format.
@@ -327,4 +491,61 @@ public:
 	void print() const;
 };
 
+inline constexpr std::array<Puzzle::Row, Puzzle::SLOTS_PER_ROW> Puzzle::SLICE_AFTER_TURN = [] {
+	std::array<Row, SLOTS_PER_ROW> table{};
+	for (int t = 0; t < SLOTS_PER_ROW; ++t) {
+		table[t] = turnRow(SLICE_MASK, -t);
+	}
+	return table;
+}();
+
+// Self-checks of the core, evaluated by the compiler
+static_assert(Puzzle().isSolved() && Puzzle().cubeShape() && Puzzle().canSlice() && Puzzle().isRowOrientationSolved());
+static_assert([] {
+	// A slice is its own inverse, and a full rotation is no turn at all
+	Puzzle puzzle;
+	puzzle.slice();
+	const bool sliced = !puzzle.isSolved() && !puzzle.isRowOrientationSolved();
+	puzzle.slice();
+	puzzle.turn(Puzzle::SLOTS_PER_ROW, -Puzzle::SLOTS_PER_ROW);
+	return sliced && puzzle.isSolved();
+}());
+static_assert([] {
+	// A move and its inverse turns undo each other
+	Puzzle puzzle;
+	puzzle.move(3, -3);
+	puzzle.move(0, 3);
+	puzzle.move(-3, 0);
+	puzzle.move(3, -3);
+	for (const auto &[topTurns, bottomTurns]: {std::pair{3, -3}, {-3, 0}, {0, 3}, {3, -3}}) {
+		puzzle.slice();
+		puzzle.turn(-topTurns, -bottomTurns);
+	}
+	return puzzle.isSolved();
+}());
+static_assert([] {
+	// The slice table agrees with turning the row first
+	for (const Puzzle::Row row: {Puzzle::SOLVED_TOP, Puzzle::SOLVED_BOTTOM}) {
+		for (int t = 0; t < Puzzle::SLOTS_PER_ROW; ++t) {
+			Puzzle turned(row, row);
+			turned.turn(t, t);
+			if (Puzzle(row, row).canSliceTopAfter(t) != turned.canSliceTop() ||
+			    Puzzle(row, row).canSliceBottomAfter(t) != turned.canSliceBottom()) {
+				return false;
+			}
+		}
+	}
+	return true;
+}());
+static_assert(Puzzle::wrapNegative(10) == -8 && Puzzle::decodeMove(Puzzle::encodeMove(-1, 4)).first == 17);
+
+/**
+ * @brief Lets puzzles key unordered containers. See Puzzle::hash()
+ */
+struct PuzzleHash {
+	constexpr std::size_t operator()(const Puzzle &puzzle) const {
+		return puzzle.hash();
+	}
+};
+
 #endif //PUZZLE_H
@@ -0,0 +1,75 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+#include <cstdint>
+#include <limits>
+
+/**
+ * @class Xoshiro256
+ *
+ * @brief A small, fast, seedable pseudorandom generator (xoshiro256**).
+ *
+ * The same seed always produces the same sequence on every platform, unlike the distributions in <random>.
+ * Satisfies UniformRandomBitGenerator, so it can also be passed to the standard library.
+ */
+class Xoshiro256 {
+public:
+	using result_type = uint64_t;
+
+	explicit Xoshiro256(uint64_t seed) {
+		// Expand the seed with SplitMix64, which never produces an all zero state
+		for (uint64_t &word: state) {
+			seed += 0x9E3779B97F4A7C15ULL;
+			uint64_t z = seed;
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+			word = z ^ (z >> 31);
+		}
+	}
+
+	static constexpr result_type min() {
+		return 0;
+	}
+
+	static constexpr result_type max() {
+		return std::numeric_limits<result_type>::max();
+	}
+
+	result_type operator()() {
+		const uint64_t result = rotl(state[1] * 5, 7) * 9;
+		const uint64_t t = state[1] << 17;
+
+		state[2] ^= state[0];
+		state[3] ^= state[1];
+		state[1] ^= state[2];
+		state[0] ^= state[3];
+		state[2] ^= t;
+		state[3] = rotl(state[3], 45);
+
+		return result;
+	}
+
+	/**
+	 * @brief Draws a uniformly distributed integer in [0, bound) without modulo bias (Lemire's method).
+	 */
+	uint64_t below(const uint64_t bound) {
+		__uint128_t product = static_cast<__uint128_t>((*this)()) * bound;
+		auto low = static_cast<uint64_t>(product);
+		if (low < bound) {
+			const uint64_t threshold = -bound % bound;
+			while (low < threshold) {
+				product = static_cast<__uint128_t>((*this)()) * bound;
+				low = static_cast<uint64_t>(product);
+			}
+		}
+		return static_cast<uint64_t>(product >> 64);
+	}
+
+private:
+	uint64_t state[4];
+
+	static constexpr uint64_t rotl(const uint64_t x, const int k) {
+		return (x << k) | (x >> (64 - k));
+	}
+};
+
+#endif //RANDOM_H
@@ -0,0 +1,83 @@
+#include "RandomState.h"
+#include <array>
+#include "Shape.h"
+
+namespace {
+	constexpr int PIECES = 12;
+
+	/**
+	 * Orders the 12 values by the rank-th permutation in lexicographic order, using the factorial number system.
+	 */
+	std::array<uint8_t, PIECES> unrankPermutation(std::array<uint8_t, PIECES> values, uint32_t rank) {
+		std::array<uint8_t, PIECES> result{};
+		uint32_t factorial = RandomState::PERMUTATIONS;
+		for (int i = 0; i < PIECES; ++i) {
+			factorial /= PIECES - i;
+			const uint32_t digit = rank / factorial;
+			rank %= factorial;
+
+			result[i] = values[digit];
+			for (int j = static_cast<int>(digit); j < PIECES - 1 - i; ++j) {
+				values[j] = values[j + 1];
+			}
+		}
+		return result;
+	}
+
+	/**
+	 * Lays the next pieces of each list into a row of the given shape, from slot 0 upwards.
+	 */
+	Puzzle::Row buildRow(const ShapeTable::RowShape shape, const std::array<uint8_t, PIECES> &corners, int &nextCorner,
+	                     const std::array<uint8_t, PIECES> &edges, int &nextEdge) {
+		Puzzle::Row row = 0;
+		for (int i = 0; i < Puzzle::SLOTS_PER_ROW; ++i) {
+			if ((shape >> i & 1) == 0) {
+				continue;
+			}
+			// The left half sits one slot above the right half, wrapping around the row. See Binary Slot Format
+			const Puzzle::Row corner = corners[nextCorner++];
+			row |= (corner | 0x10) << (i * Puzzle::SLOT_SIZE);
+			row |= corner << ((i + 1) % Puzzle::SLOTS_PER_ROW * Puzzle::SLOT_SIZE);
+		}
+
+		const ShapeTable::RowShape cornerSlots = shape | (shape << 1 | shape >> (Puzzle::SLOTS_PER_ROW - 1));
+		for (int i = 0; i < Puzzle::SLOTS_PER_ROW; ++i) {
+			if ((cornerSlots >> i & 1) == 0) {
+				row |= static_cast<Puzzle::Row>(edges[nextEdge++]) << (i * Puzzle::SLOT_SIZE);
+			}
+		}
+		return row;
+	}
+}
+
+RandomState::RandomState(const uint64_t seed) : rng(seed) {
+}
+
+Puzzle RandomState::next() {
+	const std::size_t shapeIndex = rng.below(ShapeTable::instance().size());
+	const auto cornerRank = static_cast<uint32_t>(rng.below(PERMUTATIONS));
+	const auto edgeRank = static_cast<uint32_t>(rng.below(PERMUTATIONS));
+	return unrank(shapeIndex, cornerRank, edgeRank);
+}
+
+Puzzle RandomState::unrank(const std::size_t shapeIndex, const uint32_t cornerRank, const uint32_t edgeRank) {
+	// Slot values of the left half of every corner, and of every edge, for both faces. See Binary Slot Format
+	std::array<uint8_t, PIECES> corners{};
+	std::array<uint8_t, PIECES> edges{};
+	for (int i = 0; i < PIECES / 2; ++i) {
+		corners[i] = static_cast<uint8_t>(2 * i + 1);
+		corners[i + PIECES / 2] = static_cast<uint8_t>(0x20 | (2 * i + 1));
+		edges[i] = static_cast<uint8_t>(2 * i + 2);
+		edges[i + PIECES / 2] = static_cast<uint8_t>(0x20 | (2 * i + 2));
+	}
+
+	const auto [topShape, bottomShape] = ShapeTable::instance().pair(shapeIndex);
+	const auto cornerOrder = unrankPermutation(corners, cornerRank);
+	const auto edgeOrder = unrankPermutation(edges, edgeRank);
+
+	int nextCorner = 0;
+	int nextEdge = 0;
+	const Puzzle::Row top = buildRow(topShape, cornerOrder, nextCorner, edgeOrder, nextEdge);
+	const Puzzle::Row bottom = buildRow(bottomShape, cornerOrder, nextCorner, edgeOrder, nextEdge);
+	return {top, bottom};
+}
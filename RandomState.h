@@ -0,0 +1,44 @@
+#ifndef RANDOMSTATE_H
+#define RANDOMSTATE_H
+#include <cstdint>
+#include "Puzzle.h"
+#include "Random.h"
+
+/**
+ * @class RandomState
+ *
+ * @brief Generates uniformly random reachable states.
+ *
+ * Every reachable pair of row shapes (See ShapeTable) can hold its 12 corners and 12 edges in any order,
+ * so each shape contributes exactly 12! * 12! states and a uniform state is a uniform shape plus two uniform permutations.
+ * Each of the three is unranked from a uniform integer, so the same seed always produces the same states.
+ */
+class RandomState {
+public:
+	// The number of orderings of 12 pieces
+	static constexpr uint32_t PERMUTATIONS = 479001600;
+
+	explicit RandomState(uint64_t seed);
+
+	/**
+	 * @brief Draws the next random state.
+	 */
+	Puzzle next();
+
+	/**
+	 * @brief Builds the state with the given ranks.
+	 *
+	 * Corners and edges are each placed in slot order, top row then bottom row,
+	 * with the pieces ordered by the n-th permutation (Lehmer code) of their slot values.
+	 *
+	 * @param shapeIndex Index of the pair of row shapes. See ShapeTable::pair()
+	 * @param cornerRank The permutation of the corners, in [0, 12!)
+	 * @param edgeRank The permutation of the edges, in [0, 12!)
+	 */
+	static Puzzle unrank(std::size_t shapeIndex, uint32_t cornerRank, uint32_t edgeRank);
+
+private:
+	Xoshiro256 rng;
+};
+
+#endif //RANDOMSTATE_H
@@ -0,0 +1,68 @@
+#include "Relabeling.h"
+#include <stdexcept>
+#include "Shape.h"
+
+Relabeling::Relabeling(const Puzzle &target) {
+	const Puzzle solved;
+	const ShapeTable::RowShape solvedTop = ShapeTable::shapeOf(solved.getTop());
+	const ShapeTable::RowShape solvedBottom = ShapeTable::shapeOf(solved.getBottom());
+	const ShapeTable::RowShape targetTop = ShapeTable::shapeOf(target.getTop());
+	const ShapeTable::RowShape targetBottom = ShapeTable::shapeOf(target.getBottom());
+
+	// Find the turn of each row which brings the solved shape to the target's
+	int topTurns = -1;
+	int bottomTurns = -1;
+	for (int t = 0; t < Puzzle::SLOTS_PER_ROW; ++t) {
+		if (topTurns < 0 && ShapeTable::turn(solvedTop, t) == targetTop) {
+			topTurns = t;
+		}
+		if (bottomTurns < 0 && ShapeTable::turn(solvedBottom, t) == targetBottom) {
+			bottomTurns = t;
+		}
+	}
+	if (topTurns < 0 || bottomTurns < 0) {
+		throw std::invalid_argument("The target must be in cube shape, up to a turn of each row.");
+	}
+	turn = Move::of(topTurns, bottomTurns);
+
+	Puzzle aligned = target.clone();
+	aligned.turn(-topTurns, -bottomTurns);
+
+	std::array<bool, PIECE_BITS + 1> assigned{};
+	const Puzzle::Row targetRows[] = {aligned.getTop(), aligned.getBottom()};
+	const Puzzle::Row solvedRows[] = {solved.getTop(), solved.getBottom()};
+	for (int row = 0; row < 2; ++row) {
+		for (int i = 0; i < Puzzle::SLOTS_PER_ROW; ++i) {
+			const int shift = i * Puzzle::SLOT_SIZE;
+			const auto from = static_cast<uint8_t>(targetRows[row] >> shift & PIECE_BITS);
+			const auto to = static_cast<uint8_t>(solvedRows[row] >> shift & PIECE_BITS);
+
+			// Both halves of a corner map the same way, anything else seen twice is a duplicate piece
+			if (assigned[from] && labels[from] != to) {
+				throw std::invalid_argument("The target holds a piece more than once.");
+			}
+			assigned[from] = true;
+			labels[from] = to;
+		}
+	}
+}
+
+Puzzle::Row Relabeling::applyRow(const Puzzle::Row row) const {
+	Puzzle::Row renamed = 0;
+	for (int i = 0; i < Puzzle::SLOTS_PER_ROW; ++i) {
+		const int shift = i * Puzzle::SLOT_SIZE;
+		const auto slot = static_cast<uint8_t>(row >> shift & Puzzle::SLOT_MASK);
+		renamed |= static_cast<Puzzle::Row>(labels[slot & PIECE_BITS] | (slot & CORNER_PARITY)) << shift;
+	}
+	return renamed;
+}
+
+Puzzle Relabeling::apply(const Puzzle &puzzle) const {
+	return {applyRow(puzzle.getTop()), applyRow(puzzle.getBottom())};
+}
+
+Puzzle Relabeling::target() const {
+	Puzzle turned;
+	turned.turn(turn.top, turn.bottom);
+	return turned;
+}
@@ -0,0 +1,53 @@
+#ifndef RELABELING_H
+#define RELABELING_H
+#include <array>
+#include <cstdint>
+#include "Move.h"
+#include "Puzzle.h"
+
+/**
+ * @class Relabeling
+ *
+ * @brief Renames pieces so that an arbitrary target state becomes the solved state.
+ *
+ * Moves only care where pieces are, not which pieces they are, so renaming every piece the same way in the start
+ * and the target keeps every solution the same. Renaming each piece of the target after the piece which sits in
+ * its slot when solved turns "reach the target" into "reach the solved state", which the solver and its tables
+ * already handle. See Goal::SOLVED
+ *
+ * Renaming cannot change the shape, so the target must be in cube shape up to a turn of each row, and renamed it is
+ * the solved state with that turn. The solver searches for the turned state itself (See target()), so that the turn
+ * is part of the last move rather than one made after it, and the solution stays a shortest one.
+ */
+class Relabeling {
+public:
+	/**
+	 * @throws invalid_argument If the target is not a turn away from cube shape, or holds a piece twice.
+	 */
+	explicit Relabeling(const Puzzle &target);
+
+	/**
+	 * @brief Renames every piece of a state.
+	 */
+	[[nodiscard]] Puzzle apply(const Puzzle &puzzle) const;
+
+	/**
+	 * @brief The target renamed, which is the solved state with each row turned. See Solver::setTarget()
+	 */
+	[[nodiscard]] Puzzle target() const;
+
+private:
+	// The bits of a slot which identify a piece, Face Parity and Piece ID, leaving out Corner Parity
+	static constexpr uint8_t PIECE_BITS = 0x2F;
+	// The bit of a slot telling the halves of a corner apart
+	static constexpr uint8_t CORNER_PARITY = 0x10;
+
+	// labels[piece] is the new Face Parity and Piece ID of every piece, indexed by its old ones
+	std::array<uint8_t, PIECE_BITS + 1> labels{};
+	// The turn which takes the solved state to the target's shape
+	Move turn;
+
+	[[nodiscard]] Puzzle::Row applyRow(Puzzle::Row row) const;
+};
+
+#endif //RELABELING_H
@@ -0,0 +1,153 @@
+#include "Sampler.h"
+#include <cmath>
+#include <future>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include "RandomState.h"
+#include "Shape.h"
+#include "Solver.h"
+
+namespace {
+	// z for a two-sided 95% confidence interval
+	constexpr double Z = 1.96;
+	// The number of ways to choose which 6 of the 12 corners, or edges, are on the top face
+	constexpr double FACE_CHOICES = 924;
+
+	/**
+	 * Wilson score interval for a proportion, which stays sensible for very small and empty bins.
+	 */
+	std::pair<double, double> wilson(const uint64_t hits, const uint64_t total) {
+		const double n = static_cast<double>(total);
+		const double p = static_cast<double>(hits) / n;
+		const double denominator = 1 + Z * Z / n;
+		const double center = (p + Z * Z / (2 * n)) / denominator;
+		const double half = Z * std::sqrt(p * (1 - p) / n + Z * Z / (4 * n * n)) / denominator;
+		return {std::max(0.0, center - half), std::min(1.0, center + half)};
+	}
+}
+
+uint64_t Sampler::Histogram::total() const {
+	uint64_t sum = unsolved;
+	for (const uint64_t count: counts) {
+		sum += count;
+	}
+	return sum;
+}
+
+Sampler::Sampler(const uint64_t seed, const int limit) : seed(seed), limit(limit) {
+	if (limit < 0 || limit > Solver<>::MAX_DEPTH) {
+		throw std::invalid_argument("The limit must be within [0, " + std::to_string(Solver<>::MAX_DEPTH) + "].");
+	}
+}
+
+Sampler::Histogram Sampler::run(const uint64_t count, const unsigned threads, const uint64_t reportEvery,
+                                const std::function<void(const Histogram &)> &report) const {
+	Histogram histogram{std::vector<uint64_t>(limit + 1), 0};
+	RandomState generator(seed);
+	uint64_t drawn = 0;
+	std::mutex mutexLock;
+
+	// States are drawn in order under the lock, so the same seed always samples the same states
+	auto worker = [&]() {
+		while (true) {
+			Puzzle puzzle;
+			{
+				std::lock_guard lock(mutexLock);
+				if (drawn == count) {
+					return;
+				}
+				++drawn;
+				puzzle = generator.next();
+			}
+
+			Solver solver([](const Solver<>::Path &, bool) {
+				return true;
+			});
+			const int length = solver.solveOptimal(puzzle, limit, false);
+
+			std::lock_guard lock(mutexLock);
+			if (length < 0) {
+				++histogram.unsolved;
+			} else {
+				++histogram.counts[length];
+			}
+			if (histogram.total() % reportEvery == 0) {
+				report(histogram);
+			}
+		}
+	};
+
+	// Build the shared table before the workers race to it
+	ShapeTable::instance();
+
+	std::vector<std::future<void> > futures;
+	for (unsigned i = 0; i < threads; ++i) {
+		futures.emplace_back(std::async(std::launch::async, worker));
+	}
+	for (auto &fut: futures) {
+		fut.get();
+	}
+	return histogram;
+}
+
+void Sampler::print(const Histogram &histogram, std::ostream &stream) {
+	const uint64_t total = histogram.total();
+	if (total == 0) {
+		return;
+	}
+
+	// Formatted separately so the caller's stream flags are left alone
+	std::ostringstream out;
+	out << std::fixed << std::setprecision(3);
+
+	out << std::setw(6) << "Moves" << std::setw(12) << "States" << std::setw(12) << "Share" << "   95% interval\n";
+	uint64_t solved = 0;
+	double sum = 0;
+	double squares = 0;
+	int longest = -1;
+	for (std::size_t d = 0; d < histogram.counts.size(); ++d) {
+		const uint64_t count = histogram.counts[d];
+		if (count == 0) {
+			continue;
+		}
+		const auto [low, high] = wilson(count, total);
+		out << std::setw(6) << d << std::setw(12) << count << std::setw(11) << 100.0 * count / total << "%   [" << 100 * low << "%, " << 100 * high << "%]\n";
+		solved += count;
+		sum += static_cast<double>(d * count);
+		squares += static_cast<double>(d * d * count);
+		longest = static_cast<int>(d);
+	}
+	if (histogram.unsolved > 0) {
+		const auto [low, high] = wilson(histogram.unsolved, total);
+		out << std::setw(5) << '>' << histogram.counts.size() - 1 << std::setw(12) << histogram.unsolved << std::setw(11)
+				<< 100.0 * histogram.unsolved / total << "%   [" << 100 * low << "%, " << 100 * high << "%]\n";
+	}
+
+	if (solved > 0) {
+		const double mean = sum / solved;
+		const double deviation = std::sqrt(std::max(0.0, squares / solved - mean * mean));
+		const double half = Z * deviation / std::sqrt(static_cast<double>(solved));
+		out << "Average distance: " << mean << " +/- " << half;
+		out << (histogram.unsolved > 0 ? " (of solved states only, a lower bound)\n" : "\n");
+	}
+
+	if (histogram.unsolved > 0) {
+		out << "God's number: > " << histogram.counts.size() - 1 << " (Raise the depth limit to estimate it)\n";
+		stream << out.str();
+		return;
+	}
+
+	// Extrapolate the tail geometrically to the depth where fewer than one state of the whole space is expected
+	out << "God's number: >= " << longest;
+	if (longest >= 1 && histogram.counts[longest - 1] > histogram.counts[longest]) {
+		const double states = static_cast<double>(ShapeTable::instance().size()) * FACE_CHOICES * FACE_CHOICES;
+		const double ratio = static_cast<double>(histogram.counts[longest]) / static_cast<double>(histogram.counts[longest - 1]);
+		const double expected = states * static_cast<double>(histogram.counts[longest]) / static_cast<double>(total);
+		out << ", estimated " << longest + static_cast<int>(std::floor(std::log(expected) / -std::log(ratio)));
+	}
+	out << '\n';
+	stream << out.str();
+}
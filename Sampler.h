@@ -0,0 +1,60 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <vector>
+
+/**
+ * @class Sampler
+ *
+ * @brief Estimates the distribution of optimal solution lengths by solving uniformly random states.
+ *
+ * States come from RandomState and are solved with Solver::solveOptimal(), one state per thread at a time.
+ * The histogram is used to estimate the average distance and God's number, the length of the longest optimal solution.
+ *
+ * Solution lengths only depend on the shape of the puzzle and which face each piece belongs to,
+ * so the number of distinguishable states is the number of reachable shapes times 12-choose-6 for both corners and edges.
+ */
+class Sampler {
+public:
+	struct Histogram {
+		// counts[d] is the number of states whose shortest solution is d moves
+		std::vector<uint64_t> counts;
+		// States with no solution within the depth limit
+		uint64_t unsolved = 0;
+
+		[[nodiscard]] uint64_t total() const;
+	};
+
+	/**
+	 * @param seed The seed of the random states, so a run can be repeated exactly.
+	 * @param limit The deepest depth searched for each state. Deeper states are counted as unsolved.
+	 *
+	 * @throws invalid_argument If the limit is out of range.
+	 */
+	Sampler(uint64_t seed, int limit);
+
+	/**
+	 * @brief Solves random states on every thread.
+	 *
+	 * @param count The number of states to solve.
+	 * @param threads The number of states solved at once.
+	 * @param reportEvery How many states to solve between each call to report.
+	 * @param report Called with the partial histogram as the run goes.
+	 * @return The final histogram.
+	 */
+	Histogram run(uint64_t count, unsigned threads, uint64_t reportEvery,
+	              const std::function<void(const Histogram &)> &report) const;
+
+	/**
+	 * @brief Prints a histogram with a 95% confidence interval for every bin, and the estimates drawn from it.
+	 */
+	static void print(const Histogram &histogram, std::ostream &stream);
+
+private:
+	uint64_t seed;
+	int limit;
+};
+
+#endif //SAMPLER_H
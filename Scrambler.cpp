@@ -0,0 +1,391 @@
+#include "Scrambler.h"
+#include <algorithm>
+#include <deque>
+#include <stdexcept>
+#include "Random.h"
+#include "Shape.h"
+
+namespace {
+	constexpr int SLOTS = Puzzle::SLOTS_PER_ROW;
+	// How many generators the 3-cycle search tries as the first half of a commutator
+	constexpr int COMMUTATOR_SEARCH_LIMIT = 64;
+	// The highest power of a commutator that is checked for being a 3-cycle
+	constexpr int COMMUTATOR_MAX_POWER = 6;
+	// Random loops used to find a sequence changing only the corner or only the edge parity
+	constexpr uint64_t PARITY_SEED = 1;
+	constexpr int PARITY_WALK_LENGTH = 8;
+	constexpr int PARITY_MAX_TRIALS = 10000;
+
+	int tripleIndex(const int a, const int b, const int c) {
+		return (a * 12 + b) * 12 + c;
+	}
+
+	template<typename Positions>
+	Positions compose(const Positions &first, const Positions &second) {
+		Positions result{};
+		for (std::size_t i = 0; i < first.size(); ++i) {
+			result[i] = second[first[i]];
+		}
+		return result;
+	}
+
+	template<typename Positions>
+	Positions inverse(const Positions &positions) {
+		Positions result{};
+		for (std::size_t i = 0; i < positions.size(); ++i) {
+			result[positions[i]] = static_cast<uint8_t>(i);
+		}
+		return result;
+	}
+
+	template<typename Positions>
+	int moved(const Positions &positions) {
+		int count = 0;
+		for (std::size_t i = 0; i < positions.size(); ++i) {
+			count += positions[i] != i;
+		}
+		return count;
+	}
+
+	template<typename Positions>
+	int parity(const Positions &positions) {
+		int result = 0;
+		for (std::size_t i = 0; i < positions.size(); ++i) {
+			for (std::size_t j = i + 1; j < positions.size(); ++j) {
+				result ^= positions[i] > positions[j];
+			}
+		}
+		return result;
+	}
+}
+
+const Scrambler &Scrambler::instance() {
+	static const Scrambler scrambler;
+	return scrambler;
+}
+
+Scrambler::Turns Scrambler::invert(const Turns &turns) {
+	Turns result;
+	for (auto it = turns.rbegin(); it != turns.rend(); ++it) {
+		result.emplace_back(Puzzle::wrapPositive(-it->first), Puzzle::wrapPositive(-it->second));
+	}
+	return result;
+}
+
+void Scrambler::append(Turns &turns, const Turns &next) {
+	if (next.empty()) {
+		return;
+	}
+	if (turns.empty()) {
+		turns = next;
+		return;
+	}
+	turns.back().first = Puzzle::wrapPositive(turns.back().first + next.front().first);
+	turns.back().second = Puzzle::wrapPositive(turns.back().second + next.front().second);
+	turns.insert(turns.end(), next.begin() + 1, next.end());
+}
+
+void Scrambler::apply(Puzzle &puzzle, const Turns &turns) {
+	for (std::size_t i = 0; i < turns.size(); ++i) {
+		puzzle.turn(turns[i].first, turns[i].second);
+		if (i + 1 < turns.size()) {
+			puzzle.slice();
+		}
+	}
+}
+
+void Scrambler::labels(const Puzzle &puzzle, Positions &corners, Positions &edges) {
+	int corner = 0;
+	int edge = 0;
+	for (const Puzzle::Row row: {puzzle.getTop(), puzzle.getBottom()}) {
+		for (int i = 0; i < SLOTS; ++i) {
+			const auto slot = static_cast<uint8_t>(row >> (i * Puzzle::SLOT_SIZE) & Puzzle::SLOT_MASK);
+			// Bit 0x01 is the Corner Flag, bit 0x10 the Corner Parity. See Binary Slot Format
+			if ((slot & 0x01) == 0) {
+				edges[edge++] = slot;
+			} else if ((slot & 0x10) == 0) {
+				corners[corner++] = slot;
+			}
+		}
+	}
+}
+
+Scrambler::Action Scrambler::actionOf(const Turns &turns) {
+	const Puzzle solved;
+	Positions homeCorners{}, homeEdges{};
+	labels(solved, homeCorners, homeEdges);
+
+	Puzzle puzzle;
+	apply(puzzle, turns);
+	Positions corners{}, edges{};
+	labels(puzzle, corners, edges);
+
+	// The piece at slot j came from the slot it is solved in
+	Action action{};
+	for (int j = 0; j < PIECES; ++j) {
+		action.corners[std::find(homeCorners.begin(), homeCorners.end(), corners[j]) - homeCorners.begin()] = j;
+		action.edges[std::find(homeEdges.begin(), homeEdges.end(), edges[j]) - homeEdges.begin()] = j;
+	}
+	return action;
+}
+
+Scrambler::Scrambler() {
+	// Turning either row by one corner and edge keeps cube shape, as does any single move followed by the right turn
+	generators.push_back({{{3, 0}}, {}});
+	generators.push_back({{{0, 3}}, {}});
+
+	const Puzzle solved;
+	for (int a = 0; a < SLOTS; ++a) {
+		for (int b = 0; b < SLOTS; ++b) {
+			Puzzle sliced = solved.clone();
+			sliced.turn(a, b);
+			if (!sliced.canSlice()) {
+				continue;
+			}
+			sliced.slice();
+
+			for (int t = 0; t < SLOTS; ++t) {
+				for (int u = 0; u < SLOTS; ++u) {
+					Puzzle turned = sliced.clone();
+					turned.turn(t, u);
+					if (turned.cubeShape()) {
+						generators.push_back({{{a, b}, {t, u}}, {}});
+					}
+				}
+			}
+		}
+	}
+
+	for (Generator &generator: generators) {
+		generator.action = actionOf(generator.turns);
+		const int index = parity(generator.action.corners) * 2 + parity(generator.action.edges);
+		if (index != 0 && parityFixes[index].empty()) {
+			parityFixes[index] = generator.turns;
+		}
+	}
+	// Single moves always change the corner and edge parity together, so look for a mix among longer loops.
+	// Walk randomly away from cube shape and descend back, until a loop changes only one of the two.
+	Xoshiro256 rng(PARITY_SEED);
+	for (int trial = 0; parityFixes[1].empty() && parityFixes[2].empty() && trial < PARITY_MAX_TRIALS; ++trial) {
+		Puzzle puzzle;
+		Turns loop = {{0, 0}};
+		for (int length = 0; length < PARITY_WALK_LENGTH;) {
+			const int t = static_cast<int>(rng.below(SLOTS));
+			const int b = static_cast<int>(rng.below(SLOTS));
+			Puzzle next = puzzle.clone();
+			next.turn(t, b);
+			if (next.canSlice()) {
+				next.slice();
+				append(loop, {{t, b}, {0, 0}});
+				puzzle = next;
+				++length;
+			}
+		}
+		toCubeShape(puzzle, loop);
+
+		const Action action = actionOf(loop);
+		const int index = parity(action.corners) * 2 + parity(action.edges);
+		if (index != 0 && parityFixes[index].empty()) {
+			parityFixes[index] = loop;
+		}
+	}
+
+	for (int index = 1; index < 4; ++index) {
+		if (parityFixes[index].empty()) {
+			// Combine the other two fixes, whose parities add up to this one
+			parityFixes[index] = parityFixes[index % 3 + 1];
+			append(parityFixes[index], parityFixes[(index + 1) % 3 + 1]);
+		}
+		if (parityFixes[index].empty()) {
+			throw std::logic_error("Could not find a sequence for every permutation parity.");
+		}
+	}
+
+	// Search powers of commutators for a sequence moving only 3 corners, and one moving only 3 edges
+	for (int i = 0; i < COMMUTATOR_SEARCH_LIMIT && (cornerSetups.cycle.empty() || edgeSetups.cycle.empty()); ++i) {
+		for (std::size_t j = 0; j < generators.size(); ++j) {
+			const Action &x = generators[i].action;
+			const Action &y = generators[j].action;
+			const Action commutator{
+				compose(compose(compose(x.corners, y.corners), inverse(x.corners)), inverse(y.corners)),
+				compose(compose(compose(x.edges, y.edges), inverse(x.edges)), inverse(y.edges))
+			};
+
+			Action power = commutator;
+			for (int exponent = 1; exponent <= COMMUTATOR_MAX_POWER; ++exponent) {
+				const bool cornerCycle = moved(power.corners) == 3 && moved(power.edges) == 0;
+				const bool edgeCycle = moved(power.corners) == 0 && moved(power.edges) == 3;
+				Setups &setups = cornerCycle ? cornerSetups : edgeSetups;
+				if ((cornerCycle || edgeCycle) && setups.cycle.empty()) {
+					Turns turns = generators[i].turns;
+					append(turns, generators[j].turns);
+					append(turns, invert(generators[i].turns));
+					append(turns, invert(generators[j].turns));
+					for (int k = 0; k < exponent; ++k) {
+						append(setups.cycle, turns);
+					}
+					break;
+				}
+				power = {compose(power.corners, commutator.corners), compose(power.edges, commutator.edges)};
+			}
+		}
+	}
+
+	if (cornerSetups.cycle.empty() || edgeSetups.cycle.empty()) {
+		throw std::logic_error("Could not find a corner and an edge 3-cycle.");
+	}
+
+	buildSetups(cornerSetups, true);
+	buildSetups(edgeSetups, false);
+}
+
+void Scrambler::buildSetups(Setups &setups, const bool corners) const {
+	const Action cycleAction = actionOf(setups.cycle);
+	const Positions &cycle = corners ? cycleAction.corners : cycleAction.edges;
+
+	// Label the 3-cycle's slots so that it moves the piece in slots[0] to slots[1], and slots[1] to slots[2]
+	uint8_t first = 0;
+	while (cycle[first] == first) {
+		++first;
+	}
+	setups.slots = {first, cycle[first], cycle[cycle[first]]};
+
+	// Breadth first search backwards from the 3-cycle's slots over every ordered triple
+	setups.next.assign(PIECES * PIECES * PIECES, -1);
+	const int target = tripleIndex(setups.slots[0], setups.slots[1], setups.slots[2]);
+	std::vector<bool> seen(setups.next.size(), false);
+	seen[target] = true;
+
+	std::deque<std::array<uint8_t, 3> > queue = {setups.slots};
+	while (!queue.empty()) {
+		const auto triple = queue.front();
+		queue.pop_front();
+
+		for (std::size_t g = 0; g < generators.size(); ++g) {
+			const Positions back = inverse(corners ? generators[g].action.corners : generators[g].action.edges);
+			const std::array<uint8_t, 3> previous = {back[triple[0]], back[triple[1]], back[triple[2]]};
+			const int index = tripleIndex(previous[0], previous[1], previous[2]);
+			if (!seen[index]) {
+				seen[index] = true;
+				setups.next[index] = static_cast<int>(g);
+				queue.push_back(previous);
+			}
+		}
+	}
+}
+
+void Scrambler::solvePieces(Puzzle &puzzle, Turns &solution, const Setups &setups, const bool corners) const {
+	Positions homeCorners{}, homeEdges{};
+	labels(Puzzle(), homeCorners, homeEdges);
+	const Positions &home = corners ? homeCorners : homeEdges;
+
+	for (int h = 0; h < PIECES; ++h) {
+		Positions currentCorners{}, currentEdges{};
+		labels(puzzle, currentCorners, currentEdges);
+		const Positions &current = corners ? currentCorners : currentEdges;
+		if (current[h] == home[h]) {
+			continue;
+		}
+
+		// Cycle the piece that belongs here into place, through some other unsolved slot
+		const int x = static_cast<int>(std::find(current.begin(), current.end(), home[h]) - current.begin());
+		int y = 0;
+		while (y == x || y == h || current[y] == home[y]) {
+			++y;
+		}
+
+		Turns setup;
+		std::array<uint8_t, 3> triple = {static_cast<uint8_t>(x), static_cast<uint8_t>(h), static_cast<uint8_t>(y)};
+		while (triple != setups.slots) {
+			const Generator &generator = generators[setups.next[tripleIndex(triple[0], triple[1], triple[2])]];
+			const Positions &action = corners ? generator.action.corners : generator.action.edges;
+			append(setup, generator.turns);
+			triple = {action[triple[0]], action[triple[1]], action[triple[2]]};
+		}
+
+		Turns conjugate = setup;
+		append(conjugate, setups.cycle);
+		append(conjugate, invert(setup));
+		apply(puzzle, conjugate);
+		append(solution, conjugate);
+	}
+}
+
+void Scrambler::toCubeShape(Puzzle &puzzle, Turns &solution) {
+	const ShapeTable &table = ShapeTable::instance();
+	uint8_t distance = table.distance(puzzle);
+	if (distance == ShapeTable::UNREACHABLE) {
+		throw std::invalid_argument("The shape of this state cannot be reached.");
+	}
+
+	// Every state has a move one step closer to cube shape, and then a turn into it
+	while (distance > 0) {
+		bool descended = false;
+		for (int t = 0; t < SLOTS && !descended; ++t) {
+			for (int b = 0; b < SLOTS && !descended; ++b) {
+				Puzzle next = puzzle.clone();
+				next.turn(t, b);
+				if (!next.canSlice()) {
+					continue;
+				}
+				next.slice();
+				if (table.distance(next) == distance - 1) {
+					append(solution, {{t, b}, {0, 0}});
+					puzzle = next;
+					--distance;
+					descended = true;
+				}
+			}
+		}
+	}
+	for (int t = 0; t < SLOTS && !puzzle.cubeShape(); ++t) {
+		for (int b = 0; b < SLOTS; ++b) {
+			Puzzle next = puzzle.clone();
+			next.turn(t, b);
+			if (next.cubeShape()) {
+				append(solution, {{t, b}});
+				puzzle = next;
+				break;
+			}
+		}
+	}
+}
+
+Scrambler::Turns Scrambler::solve(const Puzzle &puzzle) const {
+	Puzzle current = puzzle.clone();
+	Turns solution = {{0, 0}};
+
+	toCubeShape(current, solution);
+
+	Positions corners{}, edges{}, homeCorners{}, homeEdges{};
+	labels(current, corners, edges);
+	labels(Puzzle(), homeCorners, homeEdges);
+	Positions cornerOrder{}, edgeOrder{};
+	for (int i = 0; i < PIECES; ++i) {
+		cornerOrder[i] = static_cast<uint8_t>(std::find(homeCorners.begin(), homeCorners.end(), corners[i]) - homeCorners.begin());
+		edgeOrder[i] = static_cast<uint8_t>(std::find(homeEdges.begin(), homeEdges.end(), edges[i]) - homeEdges.begin());
+	}
+	const Turns &fix = parityFixes[parity(cornerOrder) * 2 + parity(edgeOrder)];
+	apply(current, fix);
+	append(solution, fix);
+
+	solvePieces(current, solution, cornerSetups, true);
+	solvePieces(current, solution, edgeSetups, false);
+
+	if (!current.isSolved()) {
+		throw std::logic_error("Constructive solve did not reach the solved state.");
+	}
+	return solution;
+}
+
+bool Scrambler::scramble(const Puzzle &puzzle, std::vector<int_fast32_t> &moves) const {
+	const Turns turns = invert(solve(puzzle));
+	for (std::size_t i = 0; i + 1 < turns.size(); ++i) {
+		moves.push_back(Puzzle::encodeMove(turns[i].first, turns[i].second));
+	}
+	if (turns.back() == std::make_pair(0, 0)) {
+		return true;
+	}
+	moves.push_back(Puzzle::encodeMove(turns.back().first, turns.back().second));
+	return false;
+}
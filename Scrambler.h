@@ -0,0 +1,119 @@
+#ifndef SCRAMBLER_H
+#define SCRAMBLER_H
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "Puzzle.h"
+
+/**
+ * @class Scrambler
+ *
+ * @brief Converts any reachable state into a scramble, a move sequence which produces it from the solved state.
+ *
+ * The state is solved constructively, far from optimally, and the solution is inverted:
+ *   1. Shape: Descend the ShapeTable one move at a time until a turn reaches cube shape.
+ *   2. Parity: Apply a cube shape preserving sequence with the same corner and edge permutation parity as the state.
+ *      Single moves always change both parities together, so the mixed ones come from longer loops through other shapes.
+ *   3. Pieces: Solve the remaining even permutations with a corner and an edge 3-cycle,
+ *      each conjugated by setup sequences that bring any three pieces into the 3-cycle's slots.
+ *
+ * Internally sequences are kept as alternating turns and slices, "t0 / t1 / ... / tn", which makes inversion trivial.
+ * The generators, 3-cycles and setup sequences are all searched for the first time the scrambler is used.
+ */
+class Scrambler {
+public:
+	// Alternating turns and slices. Each pair is a (top, bottom) turn, and a slice follows every turn but the last.
+	using Turns = std::vector<std::pair<int, int> >;
+
+	/**
+	 * @brief Gets the shared scrambler, searching for its sequences on first use.
+	 */
+	static const Scrambler &instance();
+
+	/**
+	 * @brief Finds a sequence solving a state. See class notes.
+	 *
+	 * @throws invalid_argument If the state cannot be reached.
+	 */
+	[[nodiscard]] Turns solve(const Puzzle &puzzle) const;
+
+	/**
+	 * @brief Finds a scramble producing a state from the solved state.
+	 *
+	 * @param puzzle The state to produce.
+	 * @param moves The list the scramble is recorded to, as encoded moves.
+	 * @return TRUE if the scramble ends on a slice, FALSE if the last move is only a turn.
+	 */
+	bool scramble(const Puzzle &puzzle, std::vector<int_fast32_t> &moves) const;
+
+	/**
+	 * @brief Inverts a sequence.
+	 */
+	static Turns invert(const Turns &turns);
+
+	/**
+	 * @brief Appends a sequence, merging the turns where they meet.
+	 */
+	static void append(Turns &turns, const Turns &next);
+
+	/**
+	 * @brief Applies a sequence to a puzzle.
+	 */
+	static void apply(Puzzle &puzzle, const Turns &turns);
+
+private:
+	static constexpr int PIECES = 12;
+
+	using Positions = std::array<uint8_t, PIECES>;
+
+	// The slots of a cube shape puzzle where a piece moved to, for both corners and edges
+	struct Action {
+		Positions corners;
+		Positions edges;
+	};
+
+	// A cube shape preserving sequence, and where it moves each piece
+	struct Generator {
+		Turns turns;
+		Action action;
+	};
+
+	// For every ordered triple of slots, the generator to apply next to bring it towards the 3-cycle's slots
+	struct Setups {
+		Turns cycle;
+		std::array<uint8_t, 3> slots{};
+		std::vector<int> next;
+	};
+
+	std::vector<Generator> generators;
+	// parityFixes[corner parity * 2 + edge parity], the first is empty
+	std::array<Turns, 4> parityFixes;
+	Setups cornerSetups;
+	Setups edgeSetups;
+
+	Scrambler();
+
+	/**
+	 * @brief Reads the slot values of the corners and edges of a cube shape puzzle, in slot order.
+	 */
+	static void labels(const Puzzle &puzzle, Positions &corners, Positions &edges);
+
+	static Action actionOf(const Turns &turns);
+
+	/**
+	 * @brief Brings a puzzle into cube shape by descending the ShapeTable, appending to the solution.
+	 *
+	 * @throws invalid_argument If the shape of the puzzle cannot be reached.
+	 */
+	static void toCubeShape(Puzzle &puzzle, Turns &solution);
+
+	void buildSetups(Setups &setups, bool corners) const;
+
+	/**
+	 * @brief Solves every corner or edge with the 3-cycle, appending to the solution.
+	 */
+	void solvePieces(Puzzle &puzzle, Turns &solution, const Setups &setups, bool corners) const;
+};
+
+#endif //SCRAMBLER_H
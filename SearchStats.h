@@ -0,0 +1,150 @@
+#ifndef SEARCHSTATS_H
+#define SEARCHSTATS_H
+#include <array>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+
+/**
+ * @file SearchStats.h
+ *
+ * @brief Compile-time statistics policies for the search kernel.
+ *
+ * The solver is templated on one of these policies. Every hook is called from the hot loop,
+ * so each policy must be cheap to copy, and each thread keeps its own instance which is merged once its subtree is done.
+ *
+ * Hooks:
+ *   - node(depth):     A (top, bottom) pair was turned and the puzzle was sliceable.
+ *   - rejected(depth): A node was pruned by any lower bound on the moves left. See Solver::prune()
+ *   - solution(depth): A state passed the goal check.
+ *
+ * A policy whose `enabled` is false has none of its hooks called, nor merge().
+ *
+ * ──────────────────────────────────────────────────────────────────────────────────────────────────
+ */
+
+// The deepest ply that is recorded. Deeper nodes are counted in the last bucket.
+static constexpr int STATS_MAX_DEPTH = 32;
+
+/**
+ * @struct NoStats
+ *
+ * @brief The production policy. Every hook is empty, and `enabled` being false keeps the kernel from calling any.
+ */
+struct NoStats {
+	static constexpr bool enabled = false;
+
+	static constexpr void node(int) {
+	}
+
+	static constexpr void rejected(int) {
+	}
+
+	static constexpr void solution(int) {
+	}
+
+	static constexpr void merge(const NoStats &) {
+	}
+
+	static void print(std::ostream &) {
+	}
+};
+
+/**
+ * @struct CountingStats
+ *
+ * @brief Counts every event, per depth.
+ */
+struct CountingStats {
+	static constexpr bool enabled = true;
+
+	std::array<uint64_t, STATS_MAX_DEPTH + 1> nodes{};
+	std::array<uint64_t, STATS_MAX_DEPTH + 1> rejections{};
+	std::array<uint64_t, STATS_MAX_DEPTH + 1> solutions{};
+
+	static constexpr int bucket(const int depth) {
+		return depth < STATS_MAX_DEPTH ? depth : STATS_MAX_DEPTH;
+	}
+
+	void node(const int depth) {
+		++nodes[bucket(depth)];
+	}
+
+	void rejected(const int depth) {
+		++rejections[bucket(depth)];
+	}
+
+	void solution(const int depth) {
+		++solutions[bucket(depth)];
+	}
+
+	void merge(const CountingStats &other) {
+		for (int i = 0; i <= STATS_MAX_DEPTH; ++i) {
+			nodes[i] += other.nodes[i];
+			rejections[i] += other.rejections[i];
+			solutions[i] += other.solutions[i];
+		}
+	}
+
+	void print(std::ostream &out) const {
+		out << std::setw(6) << "Depth" << std::setw(16) << "Nodes" << std::setw(16) << "Rejected" << std::setw(12) << "Solutions" << '\n';
+		for (int i = 0; i <= STATS_MAX_DEPTH; ++i) {
+			if (nodes[i] == 0 && rejections[i] == 0 && solutions[i] == 0) {
+				continue;
+			}
+			out << std::setw(6) << i << std::setw(16) << nodes[i] << std::setw(16) << rejections[i] << std::setw(12) << solutions[i] << '\n';
+		}
+	}
+};
+
+/**
+ * @struct SamplingStats
+ *
+ * @brief Records one in every `2^SHIFT` nodes, scaling the per-depth counts back up when printed.
+ *
+ * Cheaper than CountingStats for long runs, at the cost of the counts only being estimates.
+ * Solutions are rare, so they are always counted exactly.
+ */
+template<int SHIFT = 6>
+struct SamplingStats {
+	static constexpr bool enabled = true;
+	static constexpr uint64_t SAMPLE_MASK = (static_cast<uint64_t>(1) << SHIFT) - 1;
+
+	uint64_t ticks = 0;
+	std::array<uint64_t, STATS_MAX_DEPTH + 1> sampledNodes{};
+	std::array<uint64_t, STATS_MAX_DEPTH + 1> solutions{};
+
+	void node(const int depth) {
+		if ((++ticks & SAMPLE_MASK) == 0) {
+			++sampledNodes[CountingStats::bucket(depth)];
+		}
+	}
+
+	static constexpr void rejected(int) {
+	}
+
+	void solution(const int depth) {
+		++solutions[CountingStats::bucket(depth)];
+	}
+
+	void merge(const SamplingStats &other) {
+		ticks += other.ticks;
+		for (int i = 0; i <= STATS_MAX_DEPTH; ++i) {
+			sampledNodes[i] += other.sampledNodes[i];
+			solutions[i] += other.solutions[i];
+		}
+	}
+
+	void print(std::ostream &out) const {
+		out << std::setw(6) << "Depth" << std::setw(16) << "~Nodes" << std::setw(12) << "Solutions" << '\n';
+		for (int i = 0; i <= STATS_MAX_DEPTH; ++i) {
+			if (sampledNodes[i] == 0 && solutions[i] == 0) {
+				continue;
+			}
+			out << std::setw(6) << i << std::setw(16) << (sampledNodes[i] << SHIFT) << std::setw(12) << solutions[i] << '\n';
+		}
+		out << "Total nodes: " << ticks << '\n';
+	}
+};
+
+#endif //SEARCHSTATS_H
@@ -0,0 +1,198 @@
+#include "Session.h"
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <string>
+#include "Shape.h"
+
+SolverSession::SolverSession(const Puzzle &start, const int limit, const MoveSet moveSet, const Goal goal)
+	: puzzle(start), limit(limit), moveSet(moveSet),
+	  goalBits(goal == Goal::SEPARATED ? Solver<>::SEPARATED_BITS : Puzzle::ROW_MASK),
+	  solver([this](const Solver<>::Path &path, const bool endsOnSlice) {
+		  found = path;
+		  foundEndsOnSlice = endsOnSlice;
+		  return true;
+	  }, limit, moveSet, goal) {
+	if (limit < 0 || limit > Solver<>::MAX_DEPTH) {
+		throw std::invalid_argument("The limit must be within [0, " + std::to_string(Solver<>::MAX_DEPTH) + "].");
+	}
+	search();
+}
+
+void SolverSession::turn(const int topTurns, const int bottomTurns) {
+	puzzle.turn(topTurns, bottomTurns);
+	spliceTurn(topTurns, bottomTurns);
+	// Undone by merging the turn into the first move of any solution, which must keep that move in the set
+	carryBound(absorbs(topTurns) && absorbs(bottomTurns));
+	update();
+}
+
+void SolverSession::slice() {
+	Puzzle next = puzzle.clone();
+	next.slice();
+	puzzle = next;
+	spliceSlice();
+	carryBound((moveSet.turns & 1) != 0);
+	update();
+}
+
+void SolverSession::move(const int topTurns, const int bottomTurns) {
+	Puzzle next = puzzle.clone();
+	next.move(topTurns, bottomTurns);
+	puzzle = next;
+	spliceTurn(topTurns, bottomTurns);
+	spliceSlice();
+	// The move is a single move however it splices
+	const Move made = Move::of(topTurns, bottomTurns);
+	carryBound((moveSet.turns >> made.top & 1) != 0 && (moveSet.turns >> made.bottom & 1) != 0);
+	update();
+}
+
+bool SolverSession::absorbs(const int turns) const {
+	const int amount = Move::of(turns, 0).top;
+	const uint32_t all = (1u << Puzzle::SLOTS_PER_ROW) - 1;
+	const uint32_t turned = (moveSet.turns << amount | moveSet.turns >> (Puzzle::SLOTS_PER_ROW - amount)) & all;
+	return (turned & ~moveSet.turns) == 0;
+}
+
+bool SolverSession::withinMoveSet() const {
+	return std::ranges::all_of(moves, [this](const Move move) {
+		return (moveSet.turns >> move.top & 1) != 0 && (moveSet.turns >> move.bottom & 1) != 0;
+	});
+}
+
+void SolverSession::carryBound(const bool undoneWithinMoveSet) {
+	lowerBound = undoneWithinMoveSet ? std::max(0, lowerBound - 1) : 0;
+}
+
+void SolverSession::spliceTurn(const int topTurns, const int bottomTurns) {
+	if (!solved) {
+		return;
+	}
+	const Move undo = Move::of(-topTurns, -bottomTurns);
+	if (moves.empty()) {
+		if (!undo.isSliceOnly()) {
+			moves.push_back(undo);
+			sliceLast = false;
+		}
+		return;
+	}
+	moves.front() = undo.then(moves.front());
+	if (moves.size() == 1 && !sliceLast && moves.front().isSliceOnly()) {
+		moves.clear();
+		sliceLast = true;
+	}
+}
+
+void SolverSession::spliceSlice() {
+	if (!solved) {
+		return;
+	}
+	if (!moves.empty() && moves.front().isSliceOnly() && (moves.size() > 1 || sliceLast)) {
+		moves.erase(moves.begin());
+		return;
+	}
+	if (moves.empty()) {
+		sliceLast = true;
+	}
+	moves.insert(moves.begin(), Move{});
+}
+
+void SolverSession::update() {
+	if (!solved || static_cast<int>(moves.size()) > limit) {
+		search();
+		return;
+	}
+	const Puzzle key(puzzle.getTop() & goalBits, puzzle.getBottom() & goalBits);
+	if (const auto known = shortest.find(key); known != shortest.end()) {
+		lowerBound = std::max(lowerBound, known->second);
+	}
+	shortenFront();
+	remember();
+}
+
+void SolverSession::remember() {
+	if (!isOptimal()) {
+		return;
+	}
+	if (shortest.size() >= HISTORY) {
+		shortest.clear();
+	}
+	shortest.emplace(Puzzle(puzzle.getTop() & goalBits, puzzle.getBottom() & goalBits), lowerBound);
+}
+
+void SolverSession::search() {
+	++searchCount;
+	solved = solver.solveOptimal(puzzle, limit, true) >= 0;
+	if (solved) {
+		moves.assign(found.begin(), found.end());
+		sliceLast = foundEndsOnSlice;
+		lowerBound = static_cast<int>(moves.size());
+		remember();
+	}
+}
+
+void SolverSession::shortenFront() {
+	// Only moves followed by their slice can be replaced, since the target is the state after the slice
+	const int sliced = static_cast<int>(moves.size()) - (sliceLast ? 0 : 1);
+	const Puzzle from(puzzle.getTop() & goalBits, puzzle.getBottom() & goalBits);
+	for (int window = std::min(WINDOW, sliced); window >= 2 && !isOptimal(); --window) {
+		Puzzle target = from;
+		for (int i = 0; i < window; ++i) {
+			target.move(moves[i].top, moves[i].bottom);
+		}
+		for (int depth = 0; depth < window; ++depth) {
+			std::vector<Move> shorter;
+			if (reach(from, target, depth, shorter)) {
+				moves.erase(moves.begin(), moves.begin() + window);
+				moves.insert(moves.begin(), shorter.begin(), shorter.end());
+				sliceLast = sliceLast || moves.empty();
+				return;
+			}
+		}
+	}
+}
+
+bool SolverSession::reach(const Puzzle &from, const Puzzle &target, const int depth, std::vector<Move> &path) const {
+	if (from == target) {
+		return true;
+	}
+	if (depth == 0) {
+		return false;
+	}
+	const uint32_t bottoms = ShapeTable::sliceableTurns(ShapeTable::shapeOf(from.getBottom())) & moveSet.turns;
+	for (uint32_t tops = ShapeTable::sliceableTurns(ShapeTable::shapeOf(from.getTop())) & moveSet.turns; tops != 0;
+	     tops &= tops - 1) {
+		for (uint32_t turns = bottoms; turns != 0; turns &= turns - 1) {
+			const Move move{static_cast<uint8_t>(std::countr_zero(tops)), static_cast<uint8_t>(std::countr_zero(turns))};
+			Puzzle next = from.clone();
+			next.move(move.top, move.bottom);
+			path.push_back(move);
+			if (reach(next, target, depth - 1, path)) {
+				return true;
+			}
+			path.pop_back();
+		}
+	}
+	return false;
+}
+
+void SolverSession::optimize() {
+	if (!solved || isOptimal()) {
+		return;
+	}
+	const int current = static_cast<int>(moves.size());
+	const bool within = withinMoveSet();
+	++searchCount;
+	// A solution leaving the move set may be shorter than any within it, so then every length is searched
+	const int length = solver.solveOptimal(puzzle, within ? current - 1 : limit, true, lowerBound);
+	if (length >= 0) {
+		moves.assign(found.begin(), found.end());
+		sliceLast = foundEndsOnSlice;
+		lowerBound = length;
+	} else {
+		// None within the move set is shorter, or if the current solution leaves it, none is within the limit
+		lowerBound = within ? current : limit + 1;
+	}
+	remember();
+}
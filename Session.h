@@ -0,0 +1,182 @@
+#ifndef SESSION_H
+#define SESSION_H
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "Move.h"
+#include "Puzzle.h"
+#include "Solver.h"
+
+/**
+ * @class SolverSession
+ *
+ * @brief Keeps a solution up to date while the puzzle changes one turn or slice at a time, as in live tracking.
+ *
+ * Every change is undone by its inverse, so the inverse spliced onto the front of the last solution always solves
+ * the new state: a turn merges into the first move's turns, and a slice either cancels a leading slice or adds one.
+ * A user following the solution therefore just consumes it, one move at a time. A merged turn may be one the move set
+ * leaves out, which only the searches are bound to.
+ *
+ * The splice may leave detours at the front, so the first few moves are then re-optimized locally: a short search
+ * looks for fewer moves reaching the same state as they do (See WINDOW). Only when there is no solution to splice
+ * onto, or the splice goes past the limit, is the state searched from scratch.
+ *
+ * Shortest means shortest within the move set, which a solution holding a merged turn from outside it never is.
+ * A change whose undoing is itself a move within the set, merged or not, lowers the length of a shortest solution by
+ * at most one: a slice if the set turns by 0, a move whose turns it holds, or a turn it absorbs, as the full set
+ * absorbs every turn (See absorbs()). After those a lower bound is carried from the last shortest solution known, and
+ * after any other change it starts again from 0. Returning to a state already solved optimally raises it again
+ * (See HISTORY). A solution within the move set at that bound is shortest, and optimize() closes any gap left.
+ */
+class SolverSession {
+public:
+	// The most leading moves re-optimized after each change
+	static constexpr int WINDOW = 3;
+	// The most states whose shortest solution length is remembered, so that undoing a change restores its bound
+	static constexpr std::size_t HISTORY = 1 << 12;
+
+	/**
+	 * @param limit The most moves in a solution, up to Solver::MAX_DEPTH.
+	 * @param moveSet The turn amounts a solution may use for each row.
+	 * @param goal What to solve for.
+	 */
+	SolverSession(const Puzzle &start, int limit, MoveSet moveSet = MoveSet::DEFAULT, Goal goal = Goal::SEPARATED);
+
+	/**
+	 * @brief Turns the rows of the tracked puzzle. See Puzzle::turn()
+	 */
+	void turn(int topTurns, int bottomTurns);
+
+	/**
+	 * @brief Slices the tracked puzzle.
+	 *
+	 * @throws logic_error If a corner is in the way, leaving the session unchanged.
+	 */
+	void slice();
+
+	/**
+	 * @brief Turns and then slices the tracked puzzle. See Puzzle::move()
+	 *
+	 * @throws logic_error If a corner is in the way of the slice, leaving the session unchanged.
+	 */
+	void move(int topTurns, int bottomTurns);
+
+	/**
+	 * @brief Searches for a shortest solution within the move set, if the current one isn't known to be one.
+	 *
+	 * Only the lengths from the lower bound up are searched, and only those below the current solution if it is
+	 * within the move set. One that leaves it is replaced by a shortest solution within it, even a longer one.
+	 */
+	void optimize();
+
+	[[nodiscard]] const Puzzle &state() const {
+		return puzzle;
+	}
+
+	/**
+	 * @brief Whether a solution within the limit is known. If not, the other accessors are meaningless.
+	 */
+	[[nodiscard]] bool hasSolution() const {
+		return solved;
+	}
+
+	/**
+	 * @brief The moves of the current solution, as the solver reports them.
+	 */
+	[[nodiscard]] const std::vector<Move> &solution() const {
+		return moves;
+	}
+
+	/**
+	 * @brief Whether the last move of the current solution includes its slice.
+	 */
+	[[nodiscard]] bool endsOnSlice() const {
+		return sliceLast;
+	}
+
+	/**
+	 * @brief Whether the current solution is within the move set and known to be shortest there.
+	 */
+	[[nodiscard]] bool isOptimal() const {
+		return solved && static_cast<int>(moves.size()) == lowerBound && withinMoveSet();
+	}
+
+	/**
+	 * @brief How many times the solver has searched, from scratch after a change or to prove a solution shortest.
+	 */
+	[[nodiscard]] std::size_t searches() const {
+		return searchCount;
+	}
+
+private:
+	Puzzle puzzle;
+	int limit;
+	MoveSet moveSet;
+	// The bits of each slot the goal reads, so detours are replaced by moves reaching the same state on those bits
+	Puzzle::Row goalBits;
+
+	Solver<>::Path found;
+	bool foundEndsOnSlice = false;
+	Solver<> solver;
+
+	std::vector<Move> moves;
+	bool sliceLast = true;
+	bool solved = false;
+	// No solution of the current state within the move set is shorter
+	int lowerBound = 0;
+	// The length of a shortest solution of each state seen, reduced to goalBits
+	std::unordered_map<Puzzle, int, PuzzleHash> shortest;
+	std::size_t searchCount = 0;
+
+	/**
+	 * @brief Finds a shortest solution from scratch.
+	 */
+	void search();
+
+	/**
+	 * @brief Whether every turn of the move set, after the given turn of a row, is still in the set.
+	 */
+	[[nodiscard]] bool absorbs(int turns) const;
+
+	/**
+	 * @brief Whether every turn of the current solution is in the move set.
+	 */
+	[[nodiscard]] bool withinMoveSet() const;
+
+	/**
+	 * @brief Carries the lower bound across a change, if undoing the change is a move within the move set.
+	 */
+	void carryBound(bool undoneWithinMoveSet);
+
+	/**
+	 * @brief Splices the inverse of a turn onto the front of the solution.
+	 */
+	void spliceTurn(int topTurns, int bottomTurns);
+
+	/**
+	 * @brief Splices the inverse of a slice, which is another slice, onto the front of the solution.
+	 */
+	void spliceSlice();
+
+	/**
+	 * @brief Replaces the solution after a change, searching from scratch if it can't be kept.
+	 */
+	void update();
+
+	/**
+	 * @brief Replaces the first moves of the solution by fewer moves reaching the same state, if there are any.
+	 */
+	void shortenFront();
+
+	/**
+	 * @brief Records the length of the current solution if it is known to be shortest.
+	 */
+	void remember();
+
+	/**
+	 * @brief Looks for moves from a state to a target within a depth, appending them to a path.
+	 */
+	bool reach(const Puzzle &from, const Puzzle &target, int depth, std::vector<Move> &path) const;
+};
+
+#endif //SESSION_H
@@ -0,0 +1,104 @@
+#include "Shape.h"
+#include <algorithm>
+#include <bit>
+
+const ShapeTable &ShapeTable::instance() {
+	static const ShapeTable table;
+	return table;
+}
+
+ShapeTable::RowShape ShapeTable::shapeOf(const Puzzle::Row row) {
+	RowShape shape = 0;
+	for (int i = 0; i < SLOTS; ++i) {
+		// Bit 0x10 of a slot is the Corner Parity. See Binary Slot Format
+		shape |= static_cast<RowShape>(row >> (i * Puzzle::SLOT_SIZE + 4) & 1) << i;
+	}
+	return shape;
+}
+
+ShapeTable::ShapeTable() : rowClass(1u << SLOTS, 0) {
+	// A mask is a valid shape as long as no slot is both a right half and the left half of the corner below it.
+	// Shapes are numbered by rotation class, in order of the first, lowest, shape of each class.
+	std::vector<bool> seen(1u << SLOTS, false);
+	for (RowShape shape = 0; shape <= ALL_SLOTS; ++shape) {
+		if ((shape & turn(shape, SLOTS - 1)) != 0) {
+			continue;
+		}
+		rowShapes.push_back(shape);
+		if (seen[shape]) {
+			continue;
+		}
+		for (int t = 0; t < SLOTS; ++t) {
+			seen[turn(shape, t)] = true;
+			rowClass[turn(shape, t)] = static_cast<uint16_t>(classShapes.size());
+		}
+		classShapes.push_back(shape);
+	}
+
+	const std::size_t classes = classShapes.size();
+	distances.assign(classes * classes, UNREACHABLE);
+
+	// Breadth first search backwards from cube shape, over pairs of rotation classes.
+	// A move from X is slice(turn(X)), so the predecessors of Y are every turn of slice(Y),
+	// which is closed under turns, so every rotation of a pair has the same distance.
+	const Puzzle solved;
+	std::vector<uint32_t> frontier = {
+		static_cast<uint32_t>(rowClass[shapeOf(solved.getTop())] * classes + rowClass[shapeOf(solved.getBottom())])
+	};
+	distances[frontier[0]] = 0;
+
+	for (uint8_t depth = 0; !frontier.empty(); ++depth) {
+		std::vector<uint32_t> next;
+		for (const uint32_t index: frontier) {
+			const RowShape top = classShapes[index / classes];
+			const RowShape bottom = classShapes[index % classes];
+			for (uint32_t topTurns = sliceableTurns(top); topTurns != 0; topTurns &= topTurns - 1) {
+				for (uint32_t bottomTurns = sliceableTurns(bottom); bottomTurns != 0; bottomTurns &= bottomTurns - 1) {
+					RowShape slicedTop = turn(top, std::countr_zero(topTurns));
+					RowShape slicedBottom = turn(bottom, std::countr_zero(bottomTurns));
+					slice(slicedTop, slicedBottom);
+
+					const uint32_t previous = rowClass[slicedTop] * classes + rowClass[slicedBottom];
+					if (distances[previous] == UNREACHABLE) {
+						distances[previous] = depth + 1;
+						next.push_back(previous);
+					}
+				}
+			}
+		}
+		frontier = std::move(next);
+	}
+
+	// Count the reachable pairs by top shape, so pair() can find any of them without storing them all
+	reachableBefore.reserve(rowShapes.size() + 1);
+	reachableBefore.push_back(0);
+	reachableBottoms.resize(classes);
+	for (std::size_t topClass = 0; topClass < classes; ++topClass) {
+		for (const RowShape bottom: rowShapes) {
+			if (distances[topClass * classes + rowClass[bottom]] != UNREACHABLE) {
+				reachableBottoms[topClass].push_back(bottom);
+			}
+		}
+	}
+	for (const RowShape top: rowShapes) {
+		reachableBefore.push_back(reachableBefore.back() + reachableBottoms[rowClass[top]].size());
+	}
+}
+
+std::size_t ShapeTable::size() const {
+	return reachableBefore.back();
+}
+
+std::pair<ShapeTable::RowShape, ShapeTable::RowShape> ShapeTable::pair(const std::size_t index) const {
+	const auto after = std::upper_bound(reachableBefore.begin(), reachableBefore.end(), index);
+	const std::size_t top = after - reachableBefore.begin() - 1;
+	return {rowShapes[top], reachableBottoms[rowClass[rowShapes[top]]][index - reachableBefore[top]]};
+}
+
+uint8_t ShapeTable::distance(const RowShape top, const RowShape bottom) const {
+	return distances[rowClass[top] * classShapes.size() + rowClass[bottom]];
+}
+
+uint8_t ShapeTable::distance(const Puzzle &puzzle) const {
+	return distance(shapeOf(puzzle.getTop()), shapeOf(puzzle.getBottom()));
+}
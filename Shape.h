@@ -0,0 +1,118 @@
+#ifndef SHAPE_H
+#define SHAPE_H
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "Puzzle.h"
+
+/**
+ * @class ShapeTable
+ *
+ * @brief Every reachable shape of the puzzle, with how far each is from cube shape.
+ *
+ * The shape of a row is the 18-bit mask of the slots holding the right half of a corner, slot 0 being the lowest bits of the row.
+ * The left half of a corner always sits one slot above its right half, and every other slot holds an edge,
+ * so the mask alone describes the row. A turn rotates the mask and a slice swaps its upper 9 bits between the rows.
+ *
+ * Distances are measured over every rotation of each row, so they are a lower bound for any subset of turns.
+ * A distance of 0 means a single turn reaches cube shape, and in general a distance of d means d moves are needed.
+ * It follows that turning either row never changes the distance, so it is stored once per pair of rotation classes,
+ * which keeps the table small enough to stay in cache during a search.
+ *
+ * The table is built by a breadth first search from cube shape the first time it is used.
+ */
+class ShapeTable {
+public:
+	using RowShape = uint32_t;
+
+	// Distance stored for a pair of row shapes that cannot be reached
+	static constexpr uint8_t UNREACHABLE = 0xFF;
+
+	/**
+	 * @brief Gets the shared table, building it on first use.
+	 */
+	static const ShapeTable &instance();
+
+	/**
+	 * @brief Extracts the shape of an encoded row.
+	 */
+	static RowShape shapeOf(Puzzle::Row row);
+
+	/**
+	 * @brief The shape of a row after turning it, matching Puzzle::turn() where slot i moves to slot i - slots.
+	 */
+	static constexpr RowShape turn(const RowShape shape, const int slots) {
+		if (slots == 0) {
+			return shape;
+		}
+		return (shape >> slots | shape << (SLOTS - slots)) & ALL_SLOTS;
+	}
+
+	/**
+	 * @brief The shapes of both rows after a slice, matching Puzzle::slice().
+	 */
+	static constexpr void slice(RowShape &top, RowShape &bottom) {
+		const RowShape topHalf = top & HALF_SLOTS;
+		top = (top & ~HALF_SLOTS) | (bottom & HALF_SLOTS);
+		bottom = (bottom & ~HALF_SLOTS) | topHalf;
+	}
+
+	/**
+	 * @brief Every turn after which a row can be sliced, as a mask with bit t set for a turn of t.
+	 *
+	 * A turn of t is sliceable when neither slot straddling the slice axis holds the right half of a corner after it,
+	 * that is when slots 8 + t and 17 + t are free before it. Rotating the free slots by 8 and 17 lines both up on bit t.
+	 */
+	static constexpr uint32_t sliceableTurns(const RowShape shape) {
+		const RowShape free = ~shape & ALL_SLOTS;
+		return turn(free, SLICE_LOW) & turn(free, SLICE_HIGH);
+	}
+
+	/**
+	 * @brief The number of reachable pairs of row shapes.
+	 */
+	[[nodiscard]] std::size_t size() const;
+
+	/**
+	 * @brief Gets a reachable (top, bottom) pair of row shapes by index, in ascending order of (top, bottom).
+	 */
+	[[nodiscard]] std::pair<RowShape, RowShape> pair(std::size_t index) const;
+
+	/**
+	 * @brief Gets the number of moves needed to bring a pair of row shapes into cube shape.
+	 * @return The distance, or UNREACHABLE.
+	 */
+	[[nodiscard]] uint8_t distance(RowShape top, RowShape bottom) const;
+
+	/**
+	 * @brief Gets the number of moves needed to bring a puzzle into cube shape.
+	 */
+	[[nodiscard]] uint8_t distance(const Puzzle &puzzle) const;
+
+private:
+	static constexpr int SLOTS = Puzzle::SLOTS_PER_ROW;
+	static constexpr RowShape ALL_SLOTS = (1u << SLOTS) - 1;
+	// The slots whose right half of a corner straddles the slice axis. See Puzzle::canSlice()
+	static constexpr int SLICE_LOW = Puzzle::SLOTS_PER_HALF - 1;
+	static constexpr int SLICE_HIGH = SLOTS - 1;
+	static constexpr RowShape SLICE_SLOTS = 1u << SLICE_LOW | 1u << SLICE_HIGH;
+	// The slots swapped by a slice. See Puzzle::slice()
+	static constexpr RowShape HALF_SLOTS = ALL_SLOTS & ~((1u << Puzzle::SLOTS_PER_HALF) - 1);
+
+	// Every valid row shape, ascending
+	std::vector<RowShape> rowShapes;
+	// The lowest shape of each rotation class, ascending
+	std::vector<RowShape> classShapes;
+	// Rotation class of each valid row shape, by mask
+	std::vector<uint16_t> rowClass;
+	// distances[top class * classShapes.size() + bottom class]
+	std::vector<uint8_t> distances;
+	// reachableBefore[i] is the number of reachable pairs whose top shape is below rowShapes[i]
+	std::vector<std::size_t> reachableBefore;
+	// Every bottom shape reachable with a top shape of each class, ascending
+	std::vector<std::vector<RowShape> > reachableBottoms;
+
+	ShapeTable();
+};
+
+#endif //SHAPE_H
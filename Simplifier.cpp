@@ -0,0 +1,164 @@
+#include "Simplifier.h"
+#include <charconv>
+
+namespace {
+	void appendTurn(std::string &out, const int turns) {
+		char digits[4];
+		const auto [end, error] = std::to_chars(digits, digits + sizeof(digits), turns);
+		out.append(digits, end);
+	}
+}
+
+void Simplifier::clear() {
+	moves.clear();
+	pending = {};
+}
+
+void Simplifier::turn(const Move turns) {
+	pending = pending.then(turns);
+}
+
+void Simplifier::slice() {
+	if (pending.isSliceOnly() && !moves.empty()) {
+		pending = moves.back();
+		moves.pop_back();
+		return;
+	}
+	moves.push_back(pending);
+	pending = {};
+}
+
+void Simplifier::append(const Move *begin, const Move *end, const bool endsOnSlice) {
+	for (const Move *move = begin; move != end; ++move) {
+		turn(*move);
+		if (move + 1 != end || endsOnSlice) {
+			slice();
+		}
+	}
+}
+
+std::size_t Simplifier::size() const {
+	return moves.size() + (pending.isSliceOnly() ? 0 : 1);
+}
+
+std::vector<Move> Simplifier::result(bool &endsOnSlice) const {
+	std::vector<Move> result = moves;
+	endsOnSlice = pending.isSliceOnly();
+	if (!endsOnSlice) {
+		result.push_back(pending);
+	}
+	return result;
+}
+
+void Simplifier::format(std::string &out) const {
+	for (std::size_t i = 0; i < moves.size(); ++i) {
+		if (i > 0) {
+			out += ' ';
+		}
+		if (!moves[i].isSliceOnly()) {
+			appendTurn(out, moves[i].topNotation());
+			out += ' ';
+			appendTurn(out, moves[i].bottomNotation());
+			out += ' ';
+		}
+		out += '/';
+	}
+	if (!pending.isSliceOnly()) {
+		if (!moves.empty()) {
+			out += ' ';
+		}
+		appendTurn(out, pending.topNotation());
+		out += ' ';
+		appendTurn(out, pending.bottomNotation());
+	}
+}
+
+std::string Simplifier::format() const {
+	std::string out;
+	format(out);
+	return out;
+}
+
+SolutionStream::SolutionStream(std::ostream &out, std::vector<Move> prefix) : out(out), prefix(std::move(prefix)),
+                                                                                writer(&SolutionStream::write, this) {
+}
+
+SolutionStream::~SolutionStream() {
+	finish();
+}
+
+void SolutionStream::push(const Move *begin, const Move *end, const bool endsOnSlice) {
+	filling.moves.insert(filling.moves.end(), begin, end);
+	filling.ends.emplace_back(static_cast<uint32_t>(filling.moves.size()), endsOnSlice);
+	++pushed;
+
+	if (filling.ends.size() == BATCH_SIZE) {
+		hand(std::move(filling));
+		filling = {};
+	}
+}
+
+void SolutionStream::finish() {
+	if (!writer.joinable()) {
+		return;
+	}
+	hand(std::move(filling));
+	filling = {};
+	{
+		std::lock_guard lock(mutexLock);
+		finished = true;
+	}
+	changed.notify_all();
+	writer.join();
+	out.flush();
+}
+
+uint64_t SolutionStream::count() const {
+	return pushed;
+}
+
+void SolutionStream::hand(Batch &&batch) {
+	if (batch.ends.empty()) {
+		return;
+	}
+	std::unique_lock lock(mutexLock);
+	changed.wait(lock, [this] {
+		return queued.size() < MAX_QUEUED;
+	});
+	queued.push_back(std::move(batch));
+	lock.unlock();
+	changed.notify_all();
+}
+
+void SolutionStream::write() {
+	Simplifier simplifier;
+	std::string buffer;
+
+	while (true) {
+		Batch batch;
+		{
+			std::unique_lock lock(mutexLock);
+			changed.wait(lock, [this] {
+				return finished || !queued.empty();
+			});
+			if (queued.empty()) {
+				return;
+			}
+			batch = std::move(queued.front());
+			queued.pop_front();
+		}
+		changed.notify_all();
+
+		buffer.clear();
+		uint32_t begin = 0;
+		for (const auto &[end, endsOnSlice]: batch.ends) {
+			simplifier.clear();
+			simplifier.append(prefix.data(), prefix.data() + prefix.size(), true);
+			simplifier.append(batch.moves.data() + begin, batch.moves.data() + end, endsOnSlice);
+			simplifier.format(buffer);
+			buffer += '\n';
+			begin = end;
+		}
+		out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+	}
+}
@@ -0,0 +1,137 @@
+#ifndef SIMPLIFIER_H
+#define SIMPLIFIER_H
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Move.h"
+
+/**
+ * @class Simplifier
+ *
+ * @brief Reduces a sequence of turns and slices in a single pass, as the moves arrive.
+ *
+ * Two rules are applied:
+ *   - Turns with no slice between them merge into one turn.
+ *   - Two slices with no turn between them cancel, which brings the turns on either side of them together.
+ *
+ * Every completed move (a turn followed by a slice) is kept on a stack, and the turn since the last slice is kept apart.
+ * A slice after an empty turn pops the last move and makes its turn pending again, so every move is pushed and popped
+ * at most once and the whole sequence is simplified in linear time.
+ */
+class Simplifier {
+public:
+	void clear();
+
+	/**
+	 * @brief Turns the rows, merging with any turn since the last slice.
+	 */
+	void turn(Move turns);
+
+	/**
+	 * @brief Slices, cancelling the last slice instead if no row was turned since.
+	 */
+	void slice();
+
+	/**
+	 * @brief Appends a solution, each move a turn followed by a slice.
+	 *
+	 * @param endsOnSlice Whether the last move includes its slice.
+	 */
+	void append(const Move *begin, const Move *end, bool endsOnSlice);
+
+	/**
+	 * @brief The number of moves, counting a final turn with no slice as a move.
+	 */
+	[[nodiscard]] std::size_t size() const;
+
+	/**
+	 * @brief The simplified moves, each followed by a slice except perhaps the last.
+	 *
+	 * @param endsOnSlice Set to FALSE if the last move is a turn with no slice.
+	 */
+	[[nodiscard]] std::vector<Move> result(bool &endsOnSlice) const;
+
+	/**
+	 * @brief Appends the simplified moves to a string, in the notation read by parseScramble().
+	 */
+	void format(std::string &out) const;
+
+	[[nodiscard]] std::string format() const;
+
+private:
+	// Completed moves, each followed by a slice
+	std::vector<Move> moves;
+	// The turn since the last slice
+	Move pending;
+};
+
+/**
+ * @class SolutionStream
+ *
+ * @brief The stage between a search and its output, which simplifies and prints solutions on a thread of its own.
+ *
+ * push() only copies the moves into the current batch, so the solution handler, which runs under the solver's lock,
+ * returns straight away. Full batches are handed to a writer thread which simplifies and formats each solution
+ * into one buffer, then writes the whole batch at once. If the writer falls behind, push() waits for it.
+ *
+ * push() must not be called concurrently, which solution handlers never are.
+ */
+class SolutionStream {
+public:
+	/**
+	 * @param out The stream each simplified solution is written to, one per line.
+	 * @param prefix Moves placed before every solution, such as the scramble that produced the starting state.
+	 */
+	explicit SolutionStream(std::ostream &out, std::vector<Move> prefix = {});
+
+	// Flushes any remaining solutions
+	~SolutionStream();
+
+	SolutionStream(const SolutionStream &) = delete;
+
+	SolutionStream &operator=(const SolutionStream &) = delete;
+
+	void push(const Move *begin, const Move *end, bool endsOnSlice);
+
+	/**
+	 * @brief Writes every solution pushed so far and stops the writer thread.
+	 */
+	void finish();
+
+	[[nodiscard]] uint64_t count() const;
+
+private:
+	// Solutions per batch, enough to make the hand-off cheap next to the formatting
+	static constexpr std::size_t BATCH_SIZE = 4096;
+	// Full batches waiting to be written before push() waits
+	static constexpr std::size_t MAX_QUEUED = 8;
+
+	struct Batch {
+		std::vector<Move> moves;
+		// Where each solution ends in `moves`, and whether it ends on a slice
+		std::vector<std::pair<uint32_t, bool> > ends;
+	};
+
+	std::ostream &out;
+	std::vector<Move> prefix;
+	Batch filling;
+	std::deque<Batch> queued;
+	uint64_t pushed = 0;
+	bool finished = false;
+
+	std::mutex mutexLock;
+	std::condition_variable changed;
+	std::thread writer;
+
+	void hand(Batch &&batch);
+
+	void write();
+};
+
+#endif //SIMPLIFIER_H
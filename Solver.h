@@ -0,0 +1,959 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+#include "Bounds.h"
+#include "Generator.h"
+#include "Move.h"
+#include "Layer.h"
+#include "Puzzle.h"
+#include "SearchStats.h"
+#include "Shape.h"
+#include "Symmetry.h"
+
+// The turn amounts of MoveSet::DEFAULT, in the order they were originally tried
+static constexpr int_fast32_t MOVES[] = {0, 3, 15, 6, 12, 9, 1, 17, 2};
+static constexpr int SIZE_OF_MOVES = std::size(MOVES);
+
+/**
+ * @brief What a solver searches for.
+ */
+enum class Goal {
+	// Cube shape with every piece on its own face, in any order
+	SEPARATED,
+	// Exactly the solved state, or a turn of it. Any other target can be solved for by relabeling the start.
+	// See Relabeling.h, Solver::setTarget()
+	SOLVED,
+	// The top row exactly solved, whatever the bottom row holds
+	TOP_LAYER,
+	// The bottom row exactly solved, whatever the top row holds
+	BOTTOM_LAYER,
+	// Separated, with the bits of each row under its target mask matching the solved state. See Solver::setTargetMask()
+	MATCHED
+};
+
+/**
+ * @class Solver
+ *
+ * @brief Depth first search for a sequence of moves that brings a puzzle into cube shape with both faces separated,
+ * or into the solved state. See Goal
+ *
+ * Every move is a turn of the top row, a turn of the bottom row, and a slice.
+ * The goal is checked both before and after the slice, so a solution may end on a turn.
+ *
+ * The move generator tracks the shape of both rows alongside the puzzle, so it only ever tries turns
+ * that leave a row sliceable (See ShapeTable::sliceableTurns()), and any node further from cube shape than
+ * the moves left is pruned (See ShapeTable::distance()). Both are exact, so the solutions found are the same
+ * as a plain search over the same turns, which keeps the larger branching factor of MoveSet::FULL tractable.
+ * A single layer needn't end in cube shape, so those goals prune near the leaves by how far each layer is from
+ * solved instead (See LayerTable), as does the solved state, which needs both.
+ * Every goal also prunes the last move by how far the faces are from separated, which needs no table (See Bounds).
+ *
+ * At the root, first moves whose successors only differ in what the goal and the move generator ignore, or in a
+ * symmetry of the puzzle (See Symmetry.h), lead to equivalent subtrees. Only one of each is searched, and every
+ * solution found under it is also reported for the others, with the rest of its moves conjugated by the symmetry.
+ *
+ * The search is templated on a statistics policy (See SearchStats.h).
+ * Every hook is called under `if constexpr (Stats::enabled)`, so with NoStats none of them is compiled and the
+ * production kernel is the uninstrumented one.
+ *
+ * @tparam Stats The statistics policy recording what the search does.
+ */
+template<typename Stats = NoStats>
+class Solver {
+public:
+	// The deepest the search can go, which is the capacity of a path
+	static constexpr int MAX_DEPTH = STATS_MAX_DEPTH;
+
+	// The moves from the starting state to the current node, stored inline
+	using Path = MoveSequence<MAX_DEPTH>;
+
+	// The bits of each slot that Goal::SEPARATED and the move generator read: Face Parity, Corner Parity and Corner Flag.
+	// States which match on these bits have exactly the same solutions. See Binary Slot Format
+	static constexpr Puzzle::Row SEPARATED_BITS = [] {
+		Puzzle::Row mask = 0;
+		for (int i = 0; i < Puzzle::SLOTS_PER_ROW; ++i) {
+			mask |= static_cast<Puzzle::Row>(0x31) << (i * Puzzle::SLOT_SIZE);
+		}
+		return mask;
+	}();
+
+	/**
+	 * @brief Called with every solution found, while holding the solver's lock.
+	 *
+	 * @param path The moves of the solution, from the starting state.
+	 * @param endsOnSlice Whether the last move includes its slice.
+	 * @return TRUE to stop the search, FALSE to keep enumerating.
+	 */
+	using SolutionHandler = std::function<bool(const Path &path, bool endsOnSlice)>;
+
+	// A solution yielded by solutions()
+	struct Solution {
+		Path path;
+		// Whether the last move includes its slice
+		bool endsOnSlice;
+	};
+
+	// The maximum number of moves searched
+	static constexpr int DEFAULT_MAX_DEPTH = 9;
+
+	/**
+	 * @param moveSet The turn amounts tried for each row. MoveSet::DEFAULT and MoveSet::FULL have their own compiled search.
+	 * @param goal The states counted as solutions.
+	 */
+	explicit Solver(SolutionHandler onSolution, int maxDepth = DEFAULT_MAX_DEPTH, MoveSet moveSet = MoveSet::DEFAULT,
+	                Goal goal = Goal::SEPARATED);
+
+	/**
+	 * @brief Searches from a starting state, with one task per top turn of the first move.
+	 *
+	 * @param start The state to search from.
+	 * @return TRUE if the solution handler stopped the search.
+	 */
+	bool solveMultithread(const Puzzle &start);
+
+	/**
+	 * @brief Searches from a starting state on the calling thread only.
+	 *
+	 * Meant for callers which already run one search per thread. See solveMultithread()
+	 *
+	 * @return TRUE if the solution handler stopped the search.
+	 */
+	bool solve(const Puzzle &start);
+
+	/**
+	 * @brief Searches from a starting state on the calling thread, yielding each solution as it is found.
+	 *
+	 * Solutions come in the same order as solve() reports them, ranked if ordering is on (See setOrdering()),
+	 * and the solution handler isn't called.
+	 * The search only runs while the caller pulls the next solution, so taking the first few and dropping the
+	 * generator stops it where it is. It also ends early once the cancellation token is set. See setCancellation()
+	 *
+	 * The solver must outlive the generator, and not search anything else until it is done with.
+	 *
+	 * @param start The state to search from.
+	 */
+	Generator<Solution> solutions(Puzzle start);
+
+	/**
+	 * @brief Finds a shortest solution by searching one depth deeper at a time.
+	 *
+	 * The solution handler must stop the search on the first solution for the result to be the shortest.
+	 *
+	 * @param start The state to search from.
+	 * @param limit The deepest depth to search.
+	 * @param multithread Whether each depth is searched with solveMultithread() or solve().
+	 * @param first The first depth to search, when no shorter solution is known to exist.
+	 * @return The number of moves in a shortest solution, or -1 if there is none within the limit or it was cancelled.
+	 */
+	int solveOptimal(const Puzzle &start, int limit, bool multithread, int first = 1);
+
+	/**
+	 * @brief The statistics merged from every task of the last search.
+	 */
+	[[nodiscard]] const Stats &stats() const;
+
+	/**
+	 * @brief Stops any search, now or later, as soon as the token is set. Used to cancel losing engines. See Portfolio.h
+	 *
+	 * @param token Must outlive the solver, or be nullptr to remove it.
+	 */
+	void setCancellation(const std::atomic<bool> *token);
+
+	/**
+	 * @brief Sets which bits of each row Goal::MATCHED compares against the solved state. See Puzzle::isSolvedByMatches()
+	 *
+	 * Masks of zero are the same goal as Goal::SEPARATED, and full masks the same as Goal::SOLVED.
+	 */
+	void setTargetMask(Puzzle::Row topMask, Puzzle::Row bottomMask);
+
+	/**
+	 * @brief Sets the state Goal::SOLVED searches for, which must be the solved state with each row turned.
+	 *
+	 * Every table bounds the moves to any turn of a row as it does to the row itself (See ShapeTable, LayerTable),
+	 * so the search stays optimal. A target which can't slice is only reached by a last move which stops after its
+	 * turn, which the move generator never makes, so each node also tries that turn. See turnOnto()
+	 *
+	 * @throws invalid_argument If the target isn't a turn of the solved state.
+	 */
+	void setTarget(const Puzzle &target);
+
+	/**
+	 * @brief Sets whether the moves at each node are tried most promising first, rather than in turn order.
+	 *
+	 * Each child is ranked by its shape distance plus a fraction of its misplaced pieces (See misplaced()),
+	 * and children are tried lowest rank first. Every child is still tried, and pruning is unchanged, so solveOptimal()
+	 * stays optimal and only the order of the solutions found changes.
+	 *
+	 * Ordering moves the first solution of a search, not how many nodes it takes to exhaust one, so it is a different
+	 * route to the first solution rather than a faster one in general. The portfolio races both. See Portfolio.h
+	 *
+	 * The goals which solve a layer, the first move of a multithreaded search and the last few moves before the depth
+	 * limit keep turn order.
+	 */
+	void setOrdering(bool ordered);
+
+private:
+	using RowShape = ShapeTable::RowShape;
+
+	// Only nodes with more moves left than this have their children ranked. See setOrdering()
+	static constexpr int ORDERING_MIN_LEFT = 2;
+	static constexpr int MOST_CHILDREN = MoveTables::TURNS * MoveTables::TURNS;
+
+	// The children of a node, as top turns * MoveTables::TURNS + bottom turns, most promising first
+	struct Ranking {
+		std::array<uint16_t, MOST_CHILDREN> order;
+		int count;
+	};
+
+	// A first move equivalent to another, and the symmetry mapping the other's subtree onto its own
+	struct Alias {
+		Move move;
+		int symmetry;
+	};
+
+	SolutionHandler onSolution;
+	int maxDepth;
+	MoveSet moveSet;
+	Goal goal;
+	// The bits of each slot that the goal reads
+	Puzzle::Row goalBits;
+	// The bits of each row that Goal::MATCHED compares
+	Puzzle::Row topMask = 0;
+	Puzzle::Row bottomMask = 0;
+	// The state Goal::SOLVED reaches, and its shape
+	Puzzle target;
+	RowShape targetTop = ShapeTable::shapeOf(Puzzle::SOLVED_TOP);
+	RowShape targetBottom = ShapeTable::shapeOf(Puzzle::SOLVED_BOTTOM);
+	// Whether the target can slice, so that every move onto it is generated. See turnOnto()
+	bool targetSliceable = true;
+	const ShapeTable &shapes;
+	// Only built for the goals which solve a layer
+	const LayerTable *layers;
+	std::atomic<bool> stopped;
+	// Set by someone else to cancel the search, never reset by it
+	const std::atomic<bool> *cancellation = nullptr;
+	// Whether children are tried closest first. See setOrdering()
+	bool ordered = false;
+	std::mutex mutexLock;
+	Stats totals;
+	// aliases[first move] lists the first moves whose subtrees were skipped in favour of it. See rootMoves()
+	std::array<std::vector<Alias>, MoveTables::TURNS * MoveTables::TURNS> aliases;
+
+	static std::size_t aliasIndex(Move move);
+
+	/**
+	 * @brief Picks one first move from every class of equivalent successors, recording the rest as aliases.
+	 *
+	 * @return The bottom turns to search after each top turn, as masks indexed by the top turn.
+	 */
+	template<uint32_t TURNS>
+	std::array<uint32_t, MoveTables::TURNS> rootMoves(const Puzzle &start, RowShape topShape, RowShape bottomShape);
+
+	/**
+	 * @brief Runs the search compiled for a move set, or for any move set if TURNS is 0.
+	 */
+	template<uint32_t TURNS>
+	bool run(const Puzzle &start, bool multithread);
+
+	template<uint32_t TURNS>
+	[[nodiscard]] uint32_t allowedTurns() const;
+
+	/**
+	 * @brief Whether a node is too far from the goal to reach it within the moves left.
+	 */
+	[[nodiscard]] bool prune(const Puzzle &puzzle, RowShape topShape, RowShape bottomShape, int depth) const;
+
+	[[nodiscard]] bool reached(const Puzzle &puzzle) const;
+
+	template<uint32_t TURNS>
+	void search(const Puzzle &puzzle, RowShape topShape, RowShape bottomShape, Path &path, int depth, Stats &stats);
+
+	/**
+	 * @brief Tries the given bottom turns after a top turn, checking and recursing into each child.
+	 */
+	template<uint32_t TURNS>
+	void expand(const Puzzle &topNext, int topTurns, RowShape topShape, RowShape bottomShape, uint32_t bottomTurns,
+	            Path &path, int depth, Stats &stats);
+
+	/**
+	 * @brief Orders the children of a node, closest to cube shape first. See setOrdering()
+	 *
+	 * @param bottomTurns The bottom turns to try after each top turn.
+	 */
+	[[nodiscard]] Ranking rank(const Puzzle &puzzle, RowShape topShape, RowShape bottomShape,
+	                           const std::array<uint32_t, MoveTables::TURNS> &bottomTurns) const;
+
+	/**
+	 * @brief Tries every child of a node in the order of rank().
+	 */
+	template<uint32_t TURNS>
+	void expandOrdered(const Puzzle &puzzle, RowShape topShape, RowShape bottomShape,
+	                   const std::array<uint32_t, MoveTables::TURNS> &bottomTurns, Path &path, int depth, Stats &stats);
+
+	/**
+	 * @brief Checks one child of a node and searches under it.
+	 *
+	 * @param topNext The node after its top turn.
+	 * @param topShape The shape of the top row after its turn.
+	 */
+	template<uint32_t TURNS>
+	void child(const Puzzle &topNext, int topTurns, RowShape topShape, RowShape bottomShape, int bottomTurns,
+	           Path &path, int depth, Stats &stats);
+
+	/**
+	 * @brief The turn of each row which brings a node exactly to the target, if there is one.
+	 *
+	 * Only needed for a target which can't slice, since a turn onto any other target is made by child().
+	 * Every piece is different, so at most one turn matches. See setTarget()
+	 */
+	template<uint32_t TURNS>
+	[[nodiscard]] std::optional<Move> turnOnto(const Puzzle &puzzle, RowShape topShape, RowShape bottomShape) const;
+
+	/**
+	 * @brief A solution under a first move mapped onto one of its aliases. See rootMoves()
+	 */
+	static Path mapped(const Path &path, const Alias &alias);
+
+	[[nodiscard]] bool isStopped() const;
+
+	/**
+	 * @brief The number of slots whose piece differs from the goal in a bit the goal compares. See setOrdering()
+	 *
+	 * For the separated goals, only the Face Parity is compared, counting the pieces on the wrong face.
+	 */
+	[[nodiscard]] int misplaced(const Puzzle &puzzle) const;
+
+	/**
+	 * @brief Calls the solution handler with a solution, then with the same solution mapped onto each alias of its first move.
+	 */
+	bool report(const Path &path, bool endsOnSlice);
+
+	void checkSolved(const Puzzle &puzzle, const Path &path, bool endsOnSlice, int depth, Stats &stats);
+};
+
+template<typename Stats>
+Solver<Stats>::Solver(SolutionHandler onSolution, const int maxDepth, const MoveSet moveSet, const Goal goal)
+	: onSolution(std::move(onSolution)), maxDepth(std::min(maxDepth, MAX_DEPTH)), moveSet(moveSet), goal(goal),
+	  goalBits(goal == Goal::SEPARATED || goal == Goal::MATCHED ? SEPARATED_BITS : Puzzle::ROW_MASK),
+	  shapes(ShapeTable::instance()),
+	  layers(goal == Goal::SEPARATED || goal == Goal::MATCHED ? nullptr : &LayerTable::instance()), stopped(false) {
+}
+
+template<typename Stats>
+const Stats &Solver<Stats>::stats() const {
+	return totals;
+}
+
+template<typename Stats>
+void Solver<Stats>::setCancellation(const std::atomic<bool> *token) {
+	cancellation = token;
+}
+
+template<typename Stats>
+void Solver<Stats>::checkSolved(const Puzzle &puzzle, const Path &path, const bool endsOnSlice, const int depth,
+                                Stats &stats) {
+	if (reached(puzzle)) {
+		if constexpr (Stats::enabled) {
+			stats.solution(depth);
+		}
+		std::lock_guard lock(mutexLock);
+		if (!stopped.load(std::memory_order_relaxed) && report(path, endsOnSlice)) {
+			stopped.store(true, std::memory_order_relaxed);
+		}
+	}
+}
+
+template<typename Stats>
+void Solver<Stats>::setTargetMask(const Puzzle::Row topMask, const Puzzle::Row bottomMask) {
+	this->topMask = topMask;
+	this->bottomMask = bottomMask;
+	// Root moves may only be merged if they agree on every bit either mask compares
+	goalBits = goal == Goal::MATCHED ? SEPARATED_BITS | topMask | bottomMask : goalBits;
+}
+
+template<typename Stats>
+void Solver<Stats>::setTarget(const Puzzle &target) {
+	for (int top = 0; top < Puzzle::SLOTS_PER_ROW; ++top) {
+		for (int bottom = 0; bottom < Puzzle::SLOTS_PER_ROW; ++bottom) {
+			Puzzle turned;
+			turned.turn(top, bottom);
+			if (turned == target) {
+				this->target = target;
+				targetTop = ShapeTable::shapeOf(target.getTop());
+				targetBottom = ShapeTable::shapeOf(target.getBottom());
+				targetSliceable = target.canSlice();
+				return;
+			}
+		}
+	}
+	throw std::invalid_argument("The target must be the solved state, up to a turn of each row.");
+}
+
+template<typename Stats>
+void Solver<Stats>::setOrdering(const bool ordered) {
+	this->ordered = ordered && goal != Goal::TOP_LAYER && goal != Goal::BOTTOM_LAYER;
+}
+
+template<typename Stats>
+int Solver<Stats>::misplaced(const Puzzle &puzzle) const {
+	const Puzzle::Row topBits = goal == Goal::SOLVED ? Puzzle::ROW_MASK : Bounds::FACE_BITS | topMask;
+	const Puzzle::Row bottomBits = goal == Goal::SOLVED ? Puzzle::ROW_MASK : Bounds::FACE_BITS | bottomMask;
+	auto differing = [](Puzzle::Row difference) {
+		// Folds each slot onto its lowest bit
+		difference |= difference >> 1 | difference >> 2 | difference >> 3 | difference >> 4 | difference >> 5;
+		const Puzzle::Row ones = difference & Bounds::SLOT_ONES;
+		return std::popcount(static_cast<uint64_t>(ones)) + std::popcount(static_cast<uint64_t>(ones >> 64));
+	};
+	return differing((puzzle.getTop() ^ target.getTop()) & topBits) +
+	       differing((puzzle.getBottom() ^ target.getBottom()) & bottomBits);
+}
+
+template<typename Stats>
+bool Solver<Stats>::isStopped() const {
+	return stopped.load(std::memory_order_relaxed) ||
+	       (cancellation != nullptr && cancellation->load(std::memory_order_relaxed));
+}
+
+template<typename Stats>
+bool Solver<Stats>::reached(const Puzzle &puzzle) const {
+	switch (goal) {
+		case Goal::SEPARATED:
+			return puzzle.cubeShape() && puzzle.isRowOrientationSolved();
+		case Goal::SOLVED:
+			return puzzle == target;
+		case Goal::TOP_LAYER:
+			return puzzle.isTopSolved();
+		case Goal::BOTTOM_LAYER:
+			return puzzle.isBottomSolved();
+		case Goal::MATCHED:
+			return puzzle.isSolvedByMatches(Puzzle::SOLVED_TOP, topMask, Puzzle::SOLVED_BOTTOM, bottomMask);
+	}
+	return false;
+}
+
+template<typename Stats>
+bool Solver<Stats>::report(const Path &path, const bool endsOnSlice) {
+	if (onSolution(path, endsOnSlice)) {
+		return true;
+	}
+	if (path.empty()) {
+		return false;
+	}
+
+	for (const Alias &alias: aliases[aliasIndex(path[0])]) {
+		if (onSolution(mapped(path, alias), endsOnSlice)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+template<typename Stats>
+typename Solver<Stats>::Path Solver<Stats>::mapped(const Path &path, const Alias &alias) {
+	Path result;
+	result.push_back(alias.move);
+	for (std::size_t i = 1; i < path.size(); ++i) {
+		result.push_back(Symmetry::conjugate(path[i], alias.symmetry));
+	}
+	return result;
+}
+
+template<typename Stats>
+std::size_t Solver<Stats>::aliasIndex(const Move move) {
+	return move.top * MoveTables::TURNS + move.bottom;
+}
+
+template<typename Stats>
+template<uint32_t TURNS>
+std::array<uint32_t, MoveTables::TURNS> Solver<Stats>::rootMoves(const Puzzle &start, const RowShape topShape,
+                                                                   const RowShape bottomShape) {
+	for (auto &list: aliases) {
+		list.clear();
+	}
+
+	// The flip conjugates a turn to its negation, so it only maps the move set onto itself if the set is symmetric.
+	// It also moves every piece, so it only keeps a goal which ignores which piece is which.
+	const uint32_t allowed = allowedTurns<TURNS>();
+	bool symmetric = goal == Goal::SEPARATED;
+	for (int t = 0; t < MoveTables::TURNS; ++t) {
+		symmetric &= ((allowed >> t & 1) == (allowed >> MoveTables::INVERSE[t] & 1));
+	}
+	const int symmetries = symmetric ? Symmetry::COUNT : 1;
+
+	// The successors before their slice, masked to goalBits, of every first move searched so far
+	std::vector<std::pair<Puzzle, Move> > representatives;
+	std::array<uint32_t, MoveTables::TURNS> bottomTurns{};
+
+	for (uint32_t tops = ShapeTable::sliceableTurns(topShape) & allowed; tops != 0; tops &= tops - 1) {
+		const int a = std::countr_zero(tops);
+		for (uint32_t bottoms = ShapeTable::sliceableTurns(bottomShape) & allowed; bottoms != 0; bottoms &= bottoms - 1) {
+			const int b = std::countr_zero(bottoms);
+			const Move move{static_cast<uint8_t>(a), static_cast<uint8_t>(b)};
+			Puzzle next = start.clone();
+			next.turn(a, b);
+
+			bool equivalent = false;
+			for (int symmetry = 0; symmetry < symmetries && !equivalent; ++symmetry) {
+				const Puzzle image = Symmetry::apply(next, symmetry);
+				const Puzzle key(image.getTop() & goalBits, image.getBottom() & goalBits);
+				for (const auto &[representative, first]: representatives) {
+					if (representative == key) {
+						aliases[aliasIndex(first)].push_back({move, symmetry});
+						equivalent = true;
+						break;
+					}
+				}
+			}
+
+			if (!equivalent) {
+				representatives.emplace_back(Puzzle(next.getTop() & goalBits, next.getBottom() & goalBits), move);
+				bottomTurns[a] |= 1u << b;
+			}
+		}
+	}
+	return bottomTurns;
+}
+
+template<typename Stats>
+template<uint32_t TURNS>
+uint32_t Solver<Stats>::allowedTurns() const {
+	if constexpr (TURNS != 0) {
+		return TURNS;
+	} else {
+		return moveSet.turns;
+	}
+}
+
+template<typename Stats>
+bool Solver<Stats>::prune(const Puzzle &puzzle, const RowShape topShape, const RowShape bottomShape,
+                          const int depth) const {
+	const int left = maxDepth - depth;
+	// Every goal separates the faces, which is bounded in a few instructions, but never by more than Bounds::MOST
+	if (left < Bounds::MOST && Bounds::slicesToSeparate(puzzle) > left) {
+		return true;
+	}
+	if ((goal == Goal::SEPARATED || goal == Goal::SOLVED || goal == Goal::MATCHED) &&
+	    shapes.distance(topShape, bottomShape) > left) {
+		return true;
+	}
+	// Past its radius, the layer table can't prune anything
+	if (layers == nullptr || left > LayerTable::RADIUS) {
+		return false;
+	}
+	return (goal != Goal::BOTTOM_LAYER && layers->topDistance(puzzle) > left) ||
+	       (goal != Goal::TOP_LAYER && layers->bottomDistance(puzzle) > left);
+}
+
+template<typename Stats>
+template<uint32_t TURNS>
+void Solver<Stats>::expand(const Puzzle &topNext, const int topTurns, const RowShape topShape,
+                           const RowShape bottomShape, const uint32_t bottomTurns, Path &path, const int depth,
+                           Stats &stats) {
+	for (uint32_t turns = bottomTurns; turns != 0; turns &= turns - 1) {
+		if (isStopped()) {
+			return;
+		}
+		child<TURNS>(topNext, topTurns, topShape, bottomShape, std::countr_zero(turns), path, depth, stats);
+	}
+}
+
+template<typename Stats>
+typename Solver<Stats>::Ranking Solver<Stats>::rank(const Puzzle &puzzle, const RowShape topShape,
+                                                    const RowShape bottomShape,
+                                                    const std::array<uint32_t, MoveTables::TURNS> &bottomTurns) const {
+	// Children are counting sorted by rank, any beyond the last bucket being tried last in turn order
+	constexpr int BUCKETS = 16;
+	std::array<uint16_t, MOST_CHILDREN> children;
+	std::array<uint8_t, MOST_CHILDREN> distances;
+	std::array<uint16_t, BUCKETS + 1> starts{};
+	int count = 0;
+	for (int a = 0; a < MoveTables::TURNS; ++a) {
+		if (bottomTurns[a] == 0) {
+			continue;
+		}
+		Puzzle topNext = puzzle.clone();
+		topNext.turn(a, 0);
+		const RowShape turnedTop = ShapeTable::turn(topShape, a);
+		for (uint32_t turns = bottomTurns[a]; turns != 0; turns &= turns - 1) {
+			const int b = std::countr_zero(turns);
+			Puzzle next = topNext.clone();
+			next.turn(0, b);
+			next.slice();
+			RowShape nextTop = turnedTop;
+			RowShape nextBottom = ShapeTable::turn(bottomShape, b);
+			ShapeTable::slice(nextTop, nextBottom);
+
+			// A slice can move many pieces at once, so misplaced pieces are weighed well below moves of shape
+			const int rank = shapes.distance(nextTop, nextBottom) + (misplaced(next) + 3) / 4;
+			distances[count] = static_cast<uint8_t>(std::min(rank, BUCKETS - 1));
+			children[count++] = static_cast<uint16_t>(a * MoveTables::TURNS + b);
+			++starts[distances[count - 1] + 1];
+		}
+	}
+	for (int bucket = 1; bucket <= BUCKETS; ++bucket) {
+		starts[bucket] += starts[bucket - 1];
+	}
+	Ranking ranking;
+	ranking.count = count;
+	for (int i = 0; i < count; ++i) {
+		ranking.order[starts[distances[i]]++] = children[i];
+	}
+	return ranking;
+}
+
+template<typename Stats>
+template<uint32_t TURNS>
+void Solver<Stats>::expandOrdered(const Puzzle &puzzle, const RowShape topShape, const RowShape bottomShape,
+                                  const std::array<uint32_t, MoveTables::TURNS> &bottomTurns, Path &path,
+                                  const int depth, Stats &stats) {
+	const Ranking ranking = rank(puzzle, topShape, bottomShape, bottomTurns);
+	for (int i = 0; i < ranking.count; ++i) {
+		if (isStopped()) {
+			return;
+		}
+		const int a = ranking.order[i] / MoveTables::TURNS;
+		Puzzle topNext = puzzle.clone();
+		topNext.turn(a, 0);
+		child<TURNS>(topNext, a, ShapeTable::turn(topShape, a), bottomShape, ranking.order[i] % MoveTables::TURNS, path,
+		             depth, stats);
+	}
+}
+
+template<typename Stats>
+template<uint32_t TURNS>
+std::optional<Move> Solver<Stats>::turnOnto(const Puzzle &puzzle, const RowShape topShape,
+                                            const RowShape bottomShape) const {
+	for (uint32_t tops = allowedTurns<TURNS>(); tops != 0; tops &= tops - 1) {
+		const int a = std::countr_zero(tops);
+		if (ShapeTable::turn(topShape, a) != targetTop) {
+			continue;
+		}
+		for (uint32_t bottoms = allowedTurns<TURNS>(); bottoms != 0; bottoms &= bottoms - 1) {
+			const int b = std::countr_zero(bottoms);
+			if (ShapeTable::turn(bottomShape, b) != targetBottom) {
+				continue;
+			}
+			Puzzle next = puzzle.clone();
+			next.turn(a, b);
+			if (next == target) {
+				return Move{static_cast<uint8_t>(a), static_cast<uint8_t>(b)};
+			}
+		}
+	}
+	return std::nullopt;
+}
+
+template<typename Stats>
+template<uint32_t TURNS>
+void Solver<Stats>::child(const Puzzle &topNext, const int topTurns, const RowShape topShape,
+                          const RowShape bottomShape, const int bottomTurns, Path &path, const int depth,
+                          Stats &stats) {
+	Puzzle bottomNext = topNext.clone();
+	bottomNext.turn(0, bottomTurns);
+	if constexpr (Stats::enabled) {
+		stats.node(depth);
+	}
+
+	path.push_back(Move{static_cast<uint8_t>(topTurns), static_cast<uint8_t>(bottomTurns)});
+	checkSolved(bottomNext, path, false, depth, stats);
+	bottomNext.slice();
+	checkSolved(bottomNext, path, true, depth, stats);
+
+	RowShape nextTop = topShape;
+	RowShape nextBottom = ShapeTable::turn(bottomShape, bottomTurns);
+	ShapeTable::slice(nextTop, nextBottom);
+	search<TURNS>(bottomNext, nextTop, nextBottom, path, depth + 1, stats);
+	path.pop_back();
+}
+
+template<typename Stats>
+template<uint32_t TURNS>
+void Solver<Stats>::search(const Puzzle &puzzle, const RowShape topShape, const RowShape bottomShape, Path &path,
+                           const int depth, Stats &stats) {
+	if (depth >= maxDepth) {
+		return;
+	}
+	if (prune(puzzle, topShape, bottomShape, depth)) {
+		if constexpr (Stats::enabled) {
+			stats.rejected(depth);
+		}
+		return;
+	}
+	if (!targetSliceable) {
+		if (const std::optional<Move> last = turnOnto<TURNS>(puzzle, topShape, bottomShape)) {
+			path.push_back(*last);
+			checkSolved(target, path, false, depth, stats);
+			path.pop_back();
+		}
+	}
+
+	// Near the leaves, where nearly all the nodes are, ranking costs more than it saves
+	if (ordered && maxDepth - depth > ORDERING_MIN_LEFT) {
+		std::array<uint32_t, MoveTables::TURNS> bottomTurns{};
+		const uint32_t bottoms = ShapeTable::sliceableTurns(bottomShape) & allowedTurns<TURNS>();
+		for (uint32_t turns = ShapeTable::sliceableTurns(topShape) & allowedTurns<TURNS>(); turns != 0;
+		     turns &= turns - 1) {
+			bottomTurns[std::countr_zero(turns)] = bottoms;
+		}
+		expandOrdered<TURNS>(puzzle, topShape, bottomShape, bottomTurns, path, depth, stats);
+		return;
+	}
+
+	for (uint32_t turns = ShapeTable::sliceableTurns(topShape) & allowedTurns<TURNS>(); turns != 0; turns &= turns - 1) {
+		const int a = std::countr_zero(turns);
+		Puzzle topNext = puzzle.clone();
+		topNext.turn(a, 0);
+		expand<TURNS>(topNext, a, ShapeTable::turn(topShape, a), bottomShape,
+		              ShapeTable::sliceableTurns(bottomShape) & allowedTurns<TURNS>(), path, depth, stats);
+	}
+}
+
+template<typename Stats>
+template<uint32_t TURNS>
+bool Solver<Stats>::run(const Puzzle &start, const bool multithread) {
+	stopped = false;
+	totals = Stats{};
+
+	const RowShape topShape = ShapeTable::shapeOf(start.getTop());
+	const RowShape bottomShape = ShapeTable::shapeOf(start.getBottom());
+	if (maxDepth <= 0 || prune(start, topShape, bottomShape, 0)) {
+		return false;
+	}
+
+	const std::array<uint32_t, MoveTables::TURNS> bottomTurns = rootMoves<TURNS>(start, topShape, bottomShape);
+	if (!targetSliceable) {
+		if (const std::optional<Move> last = turnOnto<TURNS>(start, topShape, bottomShape)) {
+			Path path;
+			path.push_back(*last);
+			checkSolved(target, path, false, 0, totals);
+		}
+	}
+	if (ordered && !multithread) {
+		Path path;
+		expandOrdered<TURNS>(start, topShape, bottomShape, bottomTurns, path, 0, totals);
+		return stopped;
+	}
+	std::vector<std::future<void> > futures;
+	for (int a = 0; a < MoveTables::TURNS; ++a) {
+		if (bottomTurns[a] == 0) {
+			continue;
+		}
+		Puzzle topNext = start.clone();
+		topNext.turn(a, 0);
+
+		if (!multithread) {
+			Path path;
+			expand<TURNS>(topNext, a, ShapeTable::turn(topShape, a), bottomShape, bottomTurns[a], path, 0, totals);
+			continue;
+		}
+
+		futures.emplace_back(std::async(std::launch::async, [this, topNext, a, topShape, bottomShape, &bottomTurns]() {
+			Stats stats{};
+			Path path;
+			expand<TURNS>(topNext, a, ShapeTable::turn(topShape, a), bottomShape, bottomTurns[a], path, 0, stats);
+
+			if constexpr (Stats::enabled) {
+				std::lock_guard lock(mutexLock);
+				totals.merge(stats);
+			}
+		}));
+	}
+
+	for (auto &fut: futures) {
+		fut.get();
+	}
+
+	return stopped;
+}
+
+template<typename Stats>
+bool Solver<Stats>::solve(const Puzzle &start) {
+	if (moveSet == MoveSet::DEFAULT) {
+		return run<MoveSet::DEFAULT.turns>(start, false);
+	}
+	if (moveSet == MoveSet::FULL) {
+		return run<MoveSet::FULL.turns>(start, false);
+	}
+	return run<0>(start, false);
+}
+
+template<typename Stats>
+bool Solver<Stats>::solveMultithread(const Puzzle &start) {
+	if (moveSet == MoveSet::DEFAULT) {
+		return run<MoveSet::DEFAULT.turns>(start, true);
+	}
+	if (moveSet == MoveSet::FULL) {
+		return run<MoveSet::FULL.turns>(start, true);
+	}
+	return run<0>(start, true);
+}
+
+template<typename Stats>
+Generator<typename Solver<Stats>::Solution> Solver<Stats>::solutions(const Puzzle start) {
+	const RowShape startTop = ShapeTable::shapeOf(start.getTop());
+	const RowShape startBottom = ShapeTable::shapeOf(start.getBottom());
+	if (maxDepth <= 0 || prune(start, startTop, startBottom, 0)) {
+		co_return;
+	}
+	const uint32_t allowed = allowedTurns<0>();
+	const std::array<uint32_t, MoveTables::TURNS> rootBottoms = rootMoves<0>(start, startTop, startBottom);
+
+	// The same search as search(), expand() and expandOrdered(), with the recursion kept on an explicit stack so
+	// that it can suspend at any solution. Each level iterates the (top, bottom) turns of one node, either in turn
+	// order or, if the node is ranked, in the order of its ranking.
+	struct Level {
+		Puzzle puzzle;
+		RowShape topShape;
+		RowShape bottomShape;
+		// The top turns left to try, then the bottom turns left after the current one
+		uint32_t tops;
+		uint32_t bottoms;
+		int top;
+		Puzzle topNext;
+		// Whether the children are taken from rankings[depth] instead, and how many of them have been
+		bool ranked;
+		int taken;
+	};
+
+	uint32_t rootTops = 0;
+	for (int a = 0; a < MoveTables::TURNS; ++a) {
+		rootTops |= (rootBottoms[a] != 0 ? 1u : 0u) << a;
+	}
+	// One per depth, rather than per level, so that levels in turn order stay small
+	std::vector<Ranking> rankings(ordered ? maxDepth : 0);
+	std::vector<Level> stack;
+	stack.push_back({start, startTop, startBottom, rootTops, 0, 0, start, ordered, 0});
+	if (ordered) {
+		rankings[0] = rank(start, startTop, startBottom, rootBottoms);
+	}
+	Path path;
+	if (!targetSliceable) {
+		if (const std::optional<Move> last = turnOnto<0>(start, startTop, startBottom)) {
+			path.push_back(*last);
+			co_yield Solution{path, false};
+			path.pop_back();
+		}
+	}
+
+	while (!stack.empty()) {
+		if (cancellation != nullptr && cancellation->load(std::memory_order_relaxed)) {
+			co_return;
+		}
+
+		Level &level = stack.back();
+		const int depth = static_cast<int>(stack.size()) - 1;
+		int b;
+		if (level.ranked) {
+			const Ranking &ranking = rankings[depth];
+			if (level.taken == ranking.count) {
+				stack.pop_back();
+				if (!path.empty()) {
+					path.pop_back();
+				}
+				continue;
+			}
+			const int move = ranking.order[level.taken++];
+			level.top = move / MoveTables::TURNS;
+			level.topNext = level.puzzle.clone();
+			level.topNext.turn(level.top, 0);
+			b = move % MoveTables::TURNS;
+		} else {
+			if (level.bottoms == 0) {
+				if (level.tops == 0) {
+					stack.pop_back();
+					if (!path.empty()) {
+						path.pop_back();
+					}
+					continue;
+				}
+				level.top = std::countr_zero(level.tops);
+				level.tops &= level.tops - 1;
+				level.topNext = level.puzzle.clone();
+				level.topNext.turn(level.top, 0);
+				level.bottoms = depth == 0
+					                ? rootBottoms[level.top]
+					                : ShapeTable::sliceableTurns(level.bottomShape) & allowed;
+				continue;
+			}
+			b = std::countr_zero(level.bottoms);
+			level.bottoms &= level.bottoms - 1;
+		}
+		Puzzle next = level.topNext.clone();
+		next.turn(0, b);
+		path.push_back(Move{static_cast<uint8_t>(level.top), static_cast<uint8_t>(b)});
+
+		for (const bool endsOnSlice: {false, true}) {
+			if (endsOnSlice) {
+				next.slice();
+			}
+			if (!reached(next)) {
+				continue;
+			}
+			co_yield Solution{path, endsOnSlice};
+			for (const Alias &alias: aliases[aliasIndex(path[0])]) {
+				co_yield Solution{mapped(path, alias), endsOnSlice};
+			}
+		}
+
+		RowShape nextTop = ShapeTable::turn(level.topShape, level.top);
+		RowShape nextBottom = ShapeTable::turn(level.bottomShape, b);
+		ShapeTable::slice(nextTop, nextBottom);
+		if (depth + 1 < maxDepth && !prune(next, nextTop, nextBottom, depth + 1)) {
+			const uint32_t tops = ShapeTable::sliceableTurns(nextTop) & allowed;
+			const bool ranked = ordered && maxDepth - (depth + 1) > ORDERING_MIN_LEFT;
+			if (ranked) {
+				std::array<uint32_t, MoveTables::TURNS> bottomTurns{};
+				const uint32_t bottoms = ShapeTable::sliceableTurns(nextBottom) & allowed;
+				for (uint32_t turns = tops; turns != 0; turns &= turns - 1) {
+					bottomTurns[std::countr_zero(turns)] = bottoms;
+				}
+				rankings[depth + 1] = rank(next, nextTop, nextBottom, bottomTurns);
+			}
+			stack.push_back({next, nextTop, nextBottom, tops, 0, 0, next, ranked, 0});
+			if (!targetSliceable) {
+				if (const std::optional<Move> last = turnOnto<0>(next, nextTop, nextBottom)) {
+					path.push_back(*last);
+					co_yield Solution{path, false};
+					for (const Alias &alias: aliases[aliasIndex(path[0])]) {
+						co_yield Solution{mapped(path, alias), false};
+					}
+					path.pop_back();
+				}
+			}
+			continue;
+		}
+		path.pop_back();
+	}
+}
+
+template<typename Stats>
+int Solver<Stats>::solveOptimal(const Puzzle &start, const int limit, const bool multithread, const int first) {
+	stopped = false;
+	checkSolved(start, Path{}, true, 0, totals);
+	if (stopped) {
+		return 0;
+	}
+
+	for (int depth = std::max(first, 1); depth <= std::min(limit, MAX_DEPTH); ++depth) {
+		if (cancellation != nullptr && cancellation->load(std::memory_order_relaxed)) {
+			break;
+		}
+		maxDepth = depth;
+		if (multithread ? solveMultithread(start) : solve(start)) {
+			return depth;
+		}
+	}
+	return -1;
+}
+
+#endif //SOLVER_H
@@ -0,0 +1,34 @@
+#include "Symmetry.h"
+
+namespace {
+	// Bits of a slot. See Binary Slot Format
+	constexpr Puzzle::Row FACE_PARITY = 0x20;
+	constexpr Puzzle::Row CORNER_PARITY = 0x10;
+	constexpr Puzzle::Row CORNER_FLAG = 0x01;
+}
+
+Puzzle::Row Symmetry::flipRow(const Puzzle::Row row) {
+	constexpr int SLOTS = Puzzle::SLOTS_PER_ROW;
+	Puzzle::Row flipped = 0;
+	for (int i = 0; i < SLOTS; ++i) {
+		Puzzle::Row slot = row >> (i * Puzzle::SLOT_SIZE) & Puzzle::SLOT_MASK;
+		slot ^= FACE_PARITY | ((slot & CORNER_FLAG) != 0 ? CORNER_PARITY : 0);
+		flipped |= slot << ((Puzzle::SLOTS_PER_HALF - 1 - i + SLOTS) % SLOTS * Puzzle::SLOT_SIZE);
+	}
+	return flipped;
+}
+
+Puzzle Symmetry::apply(const Puzzle &puzzle, const int symmetry) {
+	if (symmetry == IDENTITY) {
+		return puzzle;
+	}
+	return {flipRow(puzzle.getBottom()), flipRow(puzzle.getTop())};
+}
+
+Symmetry::Canonical Symmetry::canonicalize(const Puzzle &puzzle) {
+	const Puzzle flipped = apply(puzzle, FLIP);
+	const bool flipLess = flipped.getTop() != puzzle.getTop()
+		                      ? flipped.getTop() < puzzle.getTop()
+		                      : flipped.getBottom() < puzzle.getBottom();
+	return flipLess ? Canonical{flipped, FLIP} : Canonical{puzzle, IDENTITY};
+}
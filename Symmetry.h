@@ -0,0 +1,73 @@
+#ifndef SYMMETRY_H
+#define SYMMETRY_H
+#include <array>
+#include "Move.h"
+#include "Puzzle.h"
+
+/**
+ * @class Symmetry
+ *
+ * @brief The whole-puzzle symmetries that commute with every move and keep the goal, and canonical forms under them.
+ *
+ * Turning the puzzle upside down, about the axis through the middle of both halves, is the only one:
+ * The rows swap, each row is mirrored so slot i moves to slot 8 - i, which keeps both halves in place,
+ * the two halves of every corner trade roles, and every piece changes face, so a separated puzzle stays separated.
+ * Rotating the puzzle as a whole moves the slice to the other half, and recoloring alone breaks the goal,
+ * which leaves a group of two.
+ *
+ * A turn of (t, b) conjugates to (-b, -t), so a search from the flipped state finds the flipped solutions.
+ * Canonicalizing a state picks the lesser of the state and its flip, so tables and transposition entries
+ * keyed on canonical states hold each pair once.
+ */
+class Symmetry {
+public:
+	static constexpr int IDENTITY = 0;
+	static constexpr int FLIP = 1;
+	// The number of symmetries, including the identity
+	static constexpr int COUNT = 2;
+
+	struct Canonical {
+		Puzzle puzzle;
+		// The symmetry which maps the original state to `puzzle`, and back again since every symmetry is its own inverse
+		int symmetry;
+	};
+
+	/**
+	 * @brief Applies a symmetry to a whole puzzle.
+	 */
+	static Puzzle apply(const Puzzle &puzzle, int symmetry);
+
+	/**
+	 * @brief Maps a state to the representative of its symmetry class.
+	 */
+	static Canonical canonicalize(const Puzzle &puzzle);
+
+	/**
+	 * @brief The move which does to a symmetric state what the given move does to the original.
+	 */
+	static constexpr Move conjugate(const Move move, const int symmetry) {
+		return CONJUGATES[symmetry][move.top][move.bottom];
+	}
+
+private:
+	using MoveTable = std::array<std::array<Move, MoveTables::TURNS>, MoveTables::TURNS>;
+
+	// CONJUGATES[symmetry][top][bottom]
+	static constexpr std::array<MoveTable, COUNT> CONJUGATES = [] {
+		std::array<MoveTable, COUNT> table{};
+		for (int t = 0; t < MoveTables::TURNS; ++t) {
+			for (int b = 0; b < MoveTables::TURNS; ++b) {
+				table[IDENTITY][t][b] = {static_cast<uint8_t>(t), static_cast<uint8_t>(b)};
+				table[FLIP][t][b] = {MoveTables::INVERSE[b], MoveTables::INVERSE[t]};
+			}
+		}
+		return table;
+	}();
+
+	static Puzzle::Row flipRow(Puzzle::Row row);
+};
+
+static_assert(Symmetry::conjugate(Move{3, 1}, Symmetry::FLIP) == Move{17, 15});
+static_assert(Symmetry::conjugate(Symmetry::conjugate(Move{5, 12}, Symmetry::FLIP), Symmetry::FLIP) == Move{5, 12});
+
+#endif //SYMMETRY_H
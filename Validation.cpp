@@ -0,0 +1,75 @@
+#include "Validation.h"
+#include <bit>
+#include <cstdint>
+#include <stdexcept>
+#include "Bounds.h"
+#include "Shape.h"
+
+namespace {
+	constexpr int SLOTS = Puzzle::SLOTS_PER_ROW;
+
+	// Bits of a slot. See Binary Slot Format
+	constexpr Puzzle::Row CORNER_PARITY = 0x10;
+
+	// Bit v is set for every slot value v of a row
+	constexpr uint64_t slotValues(const Puzzle::Row row) {
+		uint64_t values = 0;
+		for (int i = 0; i < SLOTS; ++i) {
+			values |= 1ULL << static_cast<int>(row >> (i * Puzzle::SLOT_SIZE) & Puzzle::SLOT_MASK);
+		}
+		return values;
+	}
+
+	// Every slot value of the solved state, each of which appears exactly once
+	constexpr uint64_t SOLVED_VALUES = slotValues(Puzzle::SOLVED_TOP) | slotValues(Puzzle::SOLVED_BOTTOM);
+	static_assert(std::popcount(SOLVED_VALUES) == 2 * SLOTS);
+
+	/**
+	 * @brief Whether the slot above every right half of a corner holds the left half of the same corner.
+	 */
+	bool cornersPaired(const Puzzle::Row row) {
+		// Slot i of `above` holds slot i + 1 of the row, which must differ from a right half only by its Corner Parity
+		const Puzzle::Row above = (row >> Puzzle::SLOT_SIZE | row << (Puzzle::ROW_BITS - Puzzle::SLOT_SIZE)) &
+		                          Puzzle::ROW_MASK;
+		const Puzzle::Row rightHalves = (row & CORNER_PARITY * Bounds::SLOT_ONES) >> 4;
+		return ((row ^ above ^ CORNER_PARITY * Bounds::SLOT_ONES) & rightHalves * Puzzle::SLOT_MASK) == 0;
+	}
+
+	/**
+	 * @return Why a state is unreachable, or nullptr if it is reachable.
+	 */
+	const char *firstProblem(const Puzzle &puzzle) {
+		const Puzzle::Row top = puzzle.getTop();
+		const Puzzle::Row bottom = puzzle.getBottom();
+		if (((top | bottom) & ~Puzzle::ROW_MASK) != 0) {
+			return "The state uses bits outside of its 18 slots per row.";
+		}
+
+		// 36 slots can only cover the 36 solved values if none of them repeats
+		const uint64_t values = slotValues(top) | slotValues(bottom);
+		if (std::popcount(values) != 2 * SLOTS) {
+			return "The state holds a piece more than once.";
+		}
+		if (values != SOLVED_VALUES) {
+			return "The state holds a slot value which is not a piece of the puzzle.";
+		}
+
+		if (!cornersPaired(top) || !cornersPaired(bottom)) {
+			return "The state splits the two halves of a corner.";
+		}
+		if (ShapeTable::instance().distance(puzzle) == ShapeTable::UNREACHABLE) {
+			return "The shape of this state cannot be reached.";
+		}
+		return nullptr;
+	}
+}
+
+void validateState(const Puzzle &puzzle) {
+	if (const char *problem = firstProblem(puzzle)) {
+		throw std::invalid_argument(problem);
+	}
+}
+
+bool isReachable(const Puzzle &puzzle) {
+	return firstProblem(puzzle) == nullptr;
+}
@@ -0,0 +1,33 @@
+#ifndef VALIDATION_H
+#define VALIDATION_H
+#include "Puzzle.h"
+
+/**
+ * @file Validation.h
+ *
+ * @brief Rejecting states which cannot be reached, before any search is spent on them.
+ *
+ * A state is reachable exactly when it holds every slot value of the solved state once, so no piece is missing or
+ * duplicated, the left half of every corner sits one slot above its right half, and its pair of row shapes is
+ * reachable (See ShapeTable). Any order of the pieces is reachable in any reachable shape (See RandomState.h),
+ * so there is no parity to check, and a state passing every check is solvable.
+ *
+ * Every check works on whole rows or on a 64-bit set of the slot values, so a state is checked in well under a
+ * microsecond once the shape table is built.
+ *
+ * ──────────────────────────────────────────────────────────────────────────────────────────────────
+ */
+
+/**
+ * @brief Checks that a state can be reached from the solved state. See file notes.
+ *
+ * @throws invalid_argument Describing the first check the state fails.
+ */
+void validateState(const Puzzle &puzzle);
+
+/**
+ * @brief Whether a state can be reached from the solved state, without saying why not. See validateState()
+ */
+[[nodiscard]] bool isReachable(const Puzzle &puzzle);
+
+#endif //VALIDATION_H
@@ -0,0 +1,197 @@
+"""Calls libhexsolver in-process through its C interface. See HexSolver.h
+
+The tables stay loaded between calls, so after the first solve every case costs only its search.
+States, target masks and solutions are ctypes structures with the library's own layout, so arrays of them,
+or any writable buffer packed with them such as a numpy array, are shared without copying.
+
+    solver = HexSolver()
+    state = solver.parse("3 0 / -3 -3 / 0 3 /")
+    print(solver.format(solver.solve(state)))
+
+The library is looked for in $HEXSOLVER_LIB, then next to this file and in its build directories.
+"""
+import ctypes
+import os
+
+ABI_VERSION = 1
+MAX_MOVES = 32
+
+OK, NO_SOLUTION, UNREACHABLE, INVALID_ARGUMENT, ERROR = range(5)
+GOAL_SEPARATED, GOAL_SOLVED, GOAL_TOP_LAYER, GOAL_BOTTOM_LAYER, GOAL_MATCHED = range(5)
+
+
+class Row(ctypes.Structure):
+    _fields_ = [("low", ctypes.c_uint64), ("high", ctypes.c_uint64)]
+
+    @classmethod
+    def of(cls, value):
+        return cls(value & (1 << 64) - 1, value >> 64)
+
+    def value(self):
+        return self.high << 64 | self.low
+
+
+class State(ctypes.Structure):
+    """A state, or a pair of target masks, as two encoded rows."""
+    _fields_ = [("top", Row), ("bottom", Row)]
+
+    @classmethod
+    def of(cls, top, bottom):
+        return cls(Row.of(top), Row.of(bottom))
+
+
+class Options(ctypes.Structure):
+    _fields_ = [("limit", ctypes.c_int32),
+                ("turns", ctypes.c_uint32),
+                ("goal", ctypes.c_int32),
+                ("multithread", ctypes.c_int32),
+                ("target_mask", State)]
+
+
+class Solution(ctypes.Structure):
+    _fields_ = [("status", ctypes.c_int32),
+                ("length", ctypes.c_int32),
+                ("ends_on_slice", ctypes.c_int32),
+                ("move_count", ctypes.c_int32),
+                ("moves", ctypes.c_uint8 * 2 * MAX_MOVES)]
+
+    def path(self):
+        """The moves as (top, bottom) turns in [0, 18), each followed by a slice."""
+        return [tuple(self.moves[i]) for i in range(self.move_count)]
+
+
+class HexSolverError(Exception):
+    def __init__(self, status, message):
+        super().__init__(message)
+        self.status = status
+
+
+def _find_library():
+    if "HEXSOLVER_LIB" in os.environ:
+        return os.environ["HEXSOLVER_LIB"]
+    here = os.path.dirname(os.path.abspath(__file__))
+    for directory in ("", "build", "cmake-build-release", "cmake-build-debug"):
+        path = os.path.join(here, directory, "libhexsolver.so")
+        if os.path.exists(path):
+            return path
+    return "libhexsolver.so"
+
+
+class HexSolver:
+    """One loaded library, safe to share between threads."""
+
+    def __init__(self, path=None):
+        lib = ctypes.CDLL(path or _find_library())
+        self._lib = lib
+
+        lib.hex_abi_version.restype = ctypes.c_int32
+        lib.hex_last_error.restype = ctypes.c_char_p
+        lib.hex_load_tables.argtypes = [ctypes.c_int32]
+        lib.hex_default_options.argtypes = [ctypes.POINTER(Options)]
+        lib.hex_default_options.restype = None
+        lib.hex_solved_state.argtypes = [ctypes.POINTER(State)]
+        lib.hex_solved_state.restype = None
+        lib.hex_parse_state.argtypes = [ctypes.c_char_p, ctypes.POINTER(State)]
+        lib.hex_parse_mask.argtypes = [ctypes.c_char_p, ctypes.POINTER(State)]
+        lib.hex_validate_state.argtypes = [ctypes.POINTER(State)]
+        lib.hex_solve.argtypes = [ctypes.POINTER(State), ctypes.POINTER(Options), ctypes.POINTER(Solution)]
+        lib.hex_solve_batch.argtypes = [ctypes.POINTER(State), ctypes.POINTER(State), ctypes.c_size_t,
+                                        ctypes.POINTER(Options), ctypes.POINTER(Solution)]
+        lib.hex_format_solution.argtypes = [ctypes.POINTER(Solution), ctypes.c_char_p, ctypes.c_size_t]
+        lib.hex_format_solution.restype = ctypes.c_size_t
+        for name in ("hex_load_tables", "hex_parse_state", "hex_parse_mask", "hex_validate_state", "hex_solve",
+                     "hex_solve_batch"):
+            getattr(lib, name).restype = ctypes.c_int32
+
+        if lib.hex_abi_version() != ABI_VERSION:
+            raise HexSolverError(ERROR, "libhexsolver has ABI version %d, expected %d"
+                                 % (lib.hex_abi_version(), ABI_VERSION))
+
+    def _check(self, status, allowed=(OK,)):
+        if status not in allowed:
+            raise HexSolverError(status, self._lib.hex_last_error().decode())
+        return status
+
+    def load_tables(self, layers=False):
+        """Builds the tables now rather than in the first solve."""
+        self._check(self._lib.hex_load_tables(1 if layers else 0))
+
+    def options(self, limit=None, turns=None, goal=GOAL_SEPARATED, multithread=True, target_mask=None):
+        """Builds options from the defaults. turns is a mask, or a list of turn amounts, as in `default` or `0,3,-3`."""
+        options = Options()
+        self._lib.hex_default_options(ctypes.byref(options))
+        if limit is not None:
+            options.limit = limit
+        if turns is not None:
+            options.turns = turns if isinstance(turns, int) else sum(1 << t for t in {t % 18 for t in turns})
+        options.goal = goal
+        options.multithread = 1 if multithread else 0
+        if target_mask is not None:
+            options.target_mask = target_mask
+        return options
+
+    def solved(self):
+        state = State()
+        self._lib.hex_solved_state(ctypes.byref(state))
+        return state
+
+    def parse(self, text):
+        """Parses a scramble or a hexadecimal state, rejecting unreachable states."""
+        state = State()
+        self._check(self._lib.hex_parse_state(text.encode(), ctypes.byref(state)))
+        return state
+
+    def parse_mask(self, text):
+        """Parses target masks: `solved`, `separated` or both masks in the hexadecimal state format."""
+        mask = State()
+        self._check(self._lib.hex_parse_mask(text.encode(), ctypes.byref(mask)))
+        return mask
+
+    def is_reachable(self, state):
+        return self._check(self._lib.hex_validate_state(ctypes.byref(state)), (OK, UNREACHABLE)) == OK
+
+    def solve(self, state, options=None):
+        """Finds a shortest solution. Check its status for NO_SOLUTION or UNREACHABLE."""
+        solution = Solution()
+        self._check(self._lib.hex_solve(ctypes.byref(state), ctypes.byref(options or self.options()),
+                                        ctypes.byref(solution)), (OK, NO_SOLUTION, UNREACHABLE))
+        return solution
+
+    def solve_batch(self, states, options=None, target_masks=None, solutions=None):
+        """Solves every state of an array on every core.
+
+        states and target_masks may be arrays of State, or writable buffers of them, which are used in place.
+        The solutions are written into the given array of Solution, or a new one, which is returned.
+        """
+        states = _as_array(State, states)
+        count = len(states)
+        if target_masks is not None:
+            target_masks = _as_array(State, target_masks)
+            if len(target_masks) != count:
+                raise ValueError("One target mask is needed per state")
+        if solutions is None:
+            solutions = (Solution * count)()
+        elif len(solutions) < count:
+            raise ValueError("The solutions array is shorter than the states")
+        self._check(self._lib.hex_solve_batch(states, target_masks, count, ctypes.byref(options or self.options()),
+                                              solutions))
+        return solutions
+
+    def format(self, solution):
+        """The solution in solution notation, simplified."""
+        size = self._lib.hex_format_solution(ctypes.byref(solution), None, 0) + 1
+        buffer = ctypes.create_string_buffer(size)
+        self._lib.hex_format_solution(ctypes.byref(solution), buffer, size)
+        # Only a failure leaves an error behind, since an empty solution formats to nothing too
+        if self._lib.hex_last_error():
+            raise HexSolverError(ERROR, self._lib.hex_last_error().decode())
+        return buffer.value.decode()
+
+
+def _as_array(kind, data):
+    if isinstance(data, ctypes.Array) and data._type_ is kind:
+        return data
+    view = memoryview(data).cast("B")
+    if view.nbytes % ctypes.sizeof(kind) != 0:
+        raise ValueError("The buffer is not a whole number of %s" % kind.__name__)
+    return (kind * (view.nbytes // ctypes.sizeof(kind))).from_buffer(view)
@@ -1,179 +1,678 @@
+#include <algorithm>
+#include <atomic>
 #include <bitset>
 #include <cstdint>
+#include <fstream>
+#include <future>
 #include <iostream>
+#include <optional>
+#include <random>
 #include <vector>
-#include <future>
 #include <sstream>
+#include <stdexcept>
 #include <utility>
 #include <chrono>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include "Batch.h"
+#include "BestFirst.h"
+#include "Cost.h"
+#include "Counter.h"
+#include "Macro.h"
+#include "Move.h"
+#include "Notation.h"
+#include "Perft.h"
+#include "PieceIndex.h"
+#include "Portfolio.h"
 #include "Puzzle.h"
+#include "RandomState.h"
+#include "Relabeling.h"
+#include "Sampler.h"
+#include "Scrambler.h"
+#include "Session.h"
+#include "Simplifier.h"
+#include "Solver.h"
+#include "Validation.h"
 
-static constexpr int_fast32_t MOVES[] = {0, 3, 15, 6, 12, 9, 1, 17, 2};
-static constexpr int SIZE_OF_MOVES = std::size(MOVES);
+/**
+ * @brief Converts moves made by Puzzle::move() for the simplifier.
+ */
+std::vector<Move> decodeMoves(const std::vector<int_fast32_t> &moves) {
+	std::vector<Move> decoded;
+	decoded.reserve(moves.size());
+	for (const int_fast32_t move: moves) {
+		decoded.push_back(Move::decode(move));
+	}
+	return decoded;
+}
 
-std::mutex mutexLock;
+/**
+ * @brief Applies the default scramble to a solved puzzle, recording the moves.
+ */
+void defaultScramble(Puzzle &start, std::vector<int_fast32_t> &baseMoves) {
+	start.move(baseMoves, 0, 0);
+	start.move(baseMoves, 3, 0);
+	start.move(baseMoves, -3, -3);
+	start.move(baseMoves, 0, 3);
+	start.move(baseMoves, 1, 0);
+	start.move(baseMoves, 0, 0);
+	start.move(baseMoves, 0, 0);
+	start.move(baseMoves, 0, 0);
+	start.move(baseMoves, 0, 0);
+	start.move(baseMoves, 3, 0);
+	start.move(baseMoves, -3, -3);
+	start.move(baseMoves, 0, 3);
+}
 
-std::string formatMoves(const std::vector<int_fast32_t> &moves, const bool endsOnSlice) {
-	std::vector<int_fast32_t> ignoreZeroes = {};
+/**
+ * @brief Enumerates every solution of the default scramble up to a fixed depth, timing the search.
+ *
+ * @return the number of seconds taken.
+ */
+template<typename Stats>
+double benchmarkPolicy(const char *name, const int depth) {
+	Puzzle start;
+	std::vector<int_fast32_t> baseMoves = {};
+	defaultScramble(start, baseMoves);
 
-	int sliceParity = 0;
-	for (int i = 0; i <= moves.size(); ++i) {
-		if (i == moves.size()) {
-			if (sliceParity % 2 == 1) {
-				ignoreZeroes.push_back(moves[i - 1]);
-			}
-			break;
-		}
-		if (moves[i] == 0) {
-			sliceParity++;
-			continue;
+	uint64_t solutions = 0;
+	Solver<Stats> solver([&solutions](const typename Solver<Stats>::Path &, bool) {
+		++solutions;
+		return false;
+	}, depth);
+
+	const auto begin = std::chrono::steady_clock::now();
+	solver.solveMultithread(start);
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+	std::cout << name << ": " << elapsed.count() << "s, " << solutions << " solutions\n";
+	solver.stats().print(std::cout);
+	return elapsed.count();
+}
+
+/**
+ * @brief Compares the cost of each statistics policy on the same search.
+ *
+ * NoStats compiles every hook out of the kernel (See NoStats::enabled), so its time is that of the uninstrumented
+ * search, and the baseline the others are measured against.
+ */
+int benchmark(const int depth) {
+	static_assert(!NoStats::enabled && std::is_empty_v<NoStats>, "NoStats must compile to nothing");
+
+	const double baseline = benchmarkPolicy<NoStats>("NoStats", depth);
+	const double counting = benchmarkPolicy<CountingStats>("CountingStats", depth);
+	const double sampling = benchmarkPolicy<SamplingStats<> >("SamplingStats", depth);
+
+	std::cout << "CountingStats overhead: " << (counting / baseline - 1) * 100 << "%\n";
+	std::cout << "SamplingStats overhead: " << (sampling / baseline - 1) * 100 << "%\n";
+	return 0;
+}
+
+/**
+ * @brief Counts move sequences, and optionally distinct states, at every depth. See Perft.h
+ */
+int perft(const int depth, const bool distinct, const bool symmetric, const Puzzle &start) {
+	const auto begin = std::chrono::steady_clock::now();
+	const Perft::Result result = Perft::run(start, depth, distinct, symmetric);
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+	uint64_t total = 0;
+	for (int d = 0; d <= depth; ++d) {
+		total += result.sequences[d];
+		std::cout << "perft(" << d << ") = " << result.sequences[d];
+		if (distinct) {
+			std::cout << (symmetric ? ", classes = " : ", distinct = ") << result.distinct[d];
 		}
-		if (sliceParity % 2 == 1) {
-			ignoreZeroes.push_back(moves[i - 1]);
+		std::cout << '\n';
+	}
+	std::cout << total << " nodes in " << elapsed.count() << "s (" << total / elapsed.count() << " nodes/s)\n";
+	return 0;
+}
+
+/**
+ * @brief Prints uniformly random states, one per line, optionally followed by a scramble producing each.
+ */
+int randomStates(const uint64_t count, const uint64_t seed, const bool scrambles) {
+	RandomState generator(seed);
+	for (uint64_t i = 0; i < count; ++i) {
+		const Puzzle puzzle = generator.next();
+		std::cout << formatState(puzzle);
+		if (scrambles) {
+			std::vector<int_fast32_t> moves;
+			const bool endsOnSlice = Scrambler::instance().scramble(puzzle, moves);
+			std::cout << '\t' << formatScramble(moves, endsOnSlice);
 		}
-		ignoreZeroes.push_back(moves[i]);
-		sliceParity = 0;
-	}
-
-	std::vector<int_fast32_t> previousList = ignoreZeroes;
-	bool madeNoChange = false;
-	while (!madeNoChange) {
-		madeNoChange = true;
-		int_fast32_t lastMove = 0;
-		std::vector<int_fast32_t> ignoreDuplicates = {};
-		for (int i = 0; i < previousList.size(); ++i) {
-			if (previousList[i] == 0) {
-				continue;
-			}
+		std::cout << '\n';
+	}
+	return 0;
+}
+
+/**
+ * @brief Solves random states on every core, printing the histogram of optimal lengths as it fills. See Sampler.h
+ */
+int sample(const uint64_t count, const uint64_t seed, const int limit) {
+	const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+	const uint64_t reportEvery = std::max<uint64_t>(1, count / 20);
+
+	const Sampler sampler(seed, limit);
+	const Sampler::Histogram histogram = sampler.run(count, threads, reportEvery, [count](const Sampler::Histogram &partial) {
+		std::cout << "── " << partial.total() << " / " << count << " states ──\n";
+		Sampler::print(partial, std::cout);
+		std::cout << std::flush;
+	});
 
-			auto [lastTopTurns, lastBottomTurns] = Puzzle::decodeMove(lastMove);
-			auto [topTurns, bottomTurns] = Puzzle::decodeMove(previousList[i]);
-			if (
-				previousList[i] != 0 &&
-				lastTopTurns == Puzzle::wrapPositive(-topTurns) &&
-				lastBottomTurns == Puzzle::wrapPositive(-bottomTurns)) {
-				ignoreDuplicates.pop_back();
-				lastMove = 0;
-				madeNoChange = false;
-				continue;
+	if (histogram.total() % reportEvery != 0) {
+		Sampler::print(histogram, std::cout);
+	}
+	return 0;
+}
+
+/**
+ * @brief Solves every state of a batch file, splitting the records evenly across every core. See Batch.h
+ *
+ * Prints one line per record, in order: the length of a shortest solution and the solution, or why there is none.
+ *
+ * @param bestFirst Whether to search with BestFirst, each worker in its own arena, rather than Solver.
+ */
+int solveBatch(const std::string &path, const int limit, const MoveSet moveSet, const bool bestFirst) {
+	const BatchFile batch(path);
+	const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+	const std::size_t share = (batch.size() + threads - 1) / threads;
+	std::vector<std::string> lines(batch.size());
+
+	// Build the shared table before the workers race to it
+	ShapeTable::instance();
+
+	const auto begin = std::chrono::steady_clock::now();
+	std::vector<std::future<void> > workers;
+	for (std::size_t first = 0; first < batch.size(); first += share) {
+		const std::size_t last = std::min(batch.size(), first + share);
+		workers.emplace_back(std::async(std::launch::async, [&batch, &lines, limit, moveSet, bestFirst, threads, first,
+			                                 last]() {
+			const Goal goal = batch.hasTargets() ? Goal::MATCHED : Goal::SEPARATED;
+			Solver<>::Path solution;
+			bool solutionEndsOnSlice = false;
+			Solver solver([&](const Solver<>::Path &path, const bool endsOnSlice) {
+				solution = path;
+				solutionEndsOnSlice = endsOnSlice;
+				return true;
+			}, limit, moveSet, goal);
+			BestFirst search(limit, moveSet, goal, BestFirst::DEFAULT_MAX_NODES / threads);
+			const std::atomic<bool> never = false;
+
+			for (std::size_t i = first; i < last; ++i) {
+				const Puzzle start = batch.state(i);
+				if (!isReachable(start)) {
+					lines[i] = "unreachable";
+					continue;
+				}
+				const auto [topMask, bottomMask] = batch.targetMask(i);
+				Simplifier simplifier;
+				if (bestFirst) {
+					search.setTargetMask(topMask, bottomMask);
+					const std::optional<BestFirst::Result> found = search.solve(start, never);
+					if (!found) {
+						lines[i] = "none within " + std::to_string(limit) + " or out of memory";
+						continue;
+					}
+					simplifier.append(found->moves.data(), found->moves.data() + found->moves.size(),
+					                  found->endsOnSlice);
+				} else {
+					solver.setTargetMask(topMask, bottomMask);
+					if (solver.solveOptimal(start, limit, false) < 0) {
+						lines[i] = "none within " + std::to_string(limit);
+						continue;
+					}
+					simplifier.append(solution.begin(), solution.end(), solutionEndsOnSlice);
+				}
+				lines[i] = std::to_string(simplifier.size()) + '\t' + simplifier.format();
 			}
-			ignoreDuplicates.push_back(previousList[i]);
-			lastMove = previousList[i];
-		}
-		previousList = ignoreDuplicates;
+		}));
+	}
+	for (auto &worker: workers) {
+		worker.get();
 	}
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
 
-	std::ostringstream out;
-	std::cout << "Solution found in " << previousList.size() << " moves:\n";
+	std::string out;
+	for (const std::string &line: lines) {
+		out += line;
+		out += '\n';
+	}
+	std::cout << out;
+	std::cerr << batch.size() << " states in " << elapsed.count() << "s (" << batch.size() / elapsed.count()
+			<< " states/s)\n";
+	return 0;
+}
 
-	for (int i = 0; i < previousList.size(); ++i) {
-		const int_fast32_t move = previousList[i];
-		if (move != 0) {
-			auto [topTurns, bottomTurns] = Puzzle::decodeMove(move);
-			out << Puzzle::wrapNegative(topTurns) << " " << Puzzle::wrapNegative(bottomTurns) << " ";
-		}
+/**
+ * @brief Prints every solution within a depth as it is found, simplified on the stream's own thread. See Simplifier.h
+ *
+ * Without a state the default scramble is used, and its moves are printed before each solution.
+ *
+ * @param count If given, only the first solutions are printed, pulled one by one on this thread. See Solver::solutions()
+ */
+int enumerate(const int depth, const Puzzle *state, const MoveSet moveSet, const std::optional<std::size_t> count) {
+	Puzzle start;
+	std::vector<int_fast32_t> baseMoves = {};
+	if (state != nullptr) {
+		start = *state;
+	} else {
+		defaultScramble(start, baseMoves);
+	}
 
-		if ((i < previousList.size() - (endsOnSlice ? 0 : 1)) && !(move == 0 && i > 0)) {
-			out << "/ ";
+	SolutionStream stream(std::cout, decodeMoves(baseMoves));
+	Solver solver([&stream](const Solver<>::Path &path, const bool endsOnSlice) {
+		stream.push(path.begin(), path.end(), endsOnSlice);
+		return false;
+	}, depth, moveSet);
+
+	const auto begin = std::chrono::steady_clock::now();
+	if (count) {
+		// Pulls solutions one at a time, abandoning the search once the last one wanted is printed
+		std::size_t taken = 0;
+		if (*count != 0) {
+			for (const auto &[path, endsOnSlice]: solver.solutions(start)) {
+				stream.push(path.begin(), path.end(), endsOnSlice);
+				if (++taken == *count) {
+					break;
+				}
+			}
 		}
+	} else {
+		solver.solveMultithread(start);
 	}
+	stream.finish();
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+	std::cerr << stream.count() << " solutions in " << elapsed.count() << "s (" << stream.count() / elapsed.count()
+			<< " solutions/s)\n";
+	return 0;
+}
 
-	return out.str();
+/**
+ * @brief Prints a solution after the moves that led to its starting state, simplified together.
+ */
+void printSolution(const std::vector<int_fast32_t> &baseMoves, const Solver<>::Path &solution, const bool endsOnSlice) {
+	const std::vector<Move> prefix = decodeMoves(baseMoves);
+	Simplifier simplifier;
+	simplifier.append(prefix.data(), prefix.data() + prefix.size(), true);
+	simplifier.append(solution.begin(), solution.end(), endsOnSlice);
+	std::cout << "Solution found in " << simplifier.size() << " moves:\n" << simplifier.format() << '\n';
 }
 
-void checkSolved(const Puzzle &puzzle, const std::vector<int_fast32_t> &moves, const bool endsOnSlice) {
-	if (puzzle.cubeShape() && puzzle.isRowOrientationSolved()) {
-		std::lock_guard lock(mutexLock);
-		std::cout << formatMoves(moves, endsOnSlice);
-		std::exit(0);
+/**
+ * @brief Reads a goal named on the command line.
+ */
+Goal parseGoal(const std::string &text) {
+	if (text == "separated") {
+		return Goal::SEPARATED;
+	}
+	if (text == "solved") {
+		return Goal::SOLVED;
+	}
+	if (text == "top") {
+		return Goal::TOP_LAYER;
 	}
+	if (text == "bottom") {
+		return Goal::BOTTOM_LAYER;
+	}
+	throw std::invalid_argument("Unknown goal: " + text);
 }
 
-void solve(const Puzzle &puzzle, const std::vector<int_fast32_t> &moves, const int depth) {
-	if (depth > 8) {
-		return;
+/**
+ * @brief Finds a shortest solution of a state using the given turns, searching one depth deeper at a time.
+ *
+ * @param target `top` or `bottom` to solve only that layer, a state in cube shape to reach (See Relabeling.h),
+ * or empty to separate the faces in cube shape.
+ */
+int solveState(const Puzzle &start, const int limit, const MoveSet moveSet, const std::string &target) {
+	const bool layer = target == "top" || target == "bottom";
+	const std::optional<Relabeling> relabeling = !target.empty() && !layer
+		                                             ? std::optional(Relabeling(parsePuzzle(target)))
+		                                             : std::nullopt;
+
+	Solver<>::Path solution;
+	bool solutionEndsOnSlice = false;
+	Solver solver([&](const Solver<>::Path &path, const bool endsOnSlice) {
+		solution = path;
+		solutionEndsOnSlice = endsOnSlice;
+		return true;
+	}, limit, moveSet, layer ? parseGoal(target) : relabeling ? Goal::SOLVED : Goal::SEPARATED);
+	if (relabeling) {
+		solver.setTarget(relabeling->target());
 	}
 
-	for (int_fast32_t a = 0; a < SIZE_OF_MOVES; ++a) {
-		Puzzle topNext = puzzle.clone();
-		topNext.turn(MOVES[a], 0);
+	if (solver.solveOptimal(relabeling ? relabeling->apply(start) : start, limit, true) < 0) {
+		std::cout << "No solution found within " << limit << " moves.\n";
+		return 0;
+	}
+	printSolution({}, solution, solutionEndsOnSlice);
+	return 0;
+}
 
-		if (!topNext.canSliceTop()) {
-			continue;
-		}
+/**
+ * @brief Races the portfolio's engines on a state, printing which finished first and its solution.
+ */
+int race(const Puzzle &start, const int limit, const MoveSet moveSet, const Goal goal) {
+	const auto begin = std::chrono::steady_clock::now();
+	const std::optional<Portfolio::Result> result = Portfolio(limit, moveSet, goal).solve(start);
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
 
-		for (int_fast32_t b = 0; b < SIZE_OF_MOVES; ++b) {
-			Puzzle bottomNext = topNext.clone();
-			bottomNext.turn(0, MOVES[b]);
+	if (!result) {
+		std::cout << "No solution found within " << limit << " moves.\n";
+		return 0;
+	}
+	Simplifier simplifier;
+	simplifier.append(result->moves.data(), result->moves.data() + result->moves.size(), result->endsOnSlice);
+	std::cout << result->engine << " finished first in " << elapsed.count() << "s\n";
+	std::cout << "Solution found in " << simplifier.size() << " moves:\n" << simplifier.format() << '\n';
+	return 0;
+}
 
-			if (!bottomNext.canSliceBottom()) {
-				continue;
-			}
+/**
+ * @brief Counts the shortest solutions of a state without listing them. See Counter.h
+ */
+int countSolutions(const Puzzle &start, const int limit, const MoveSet moveSet, const Goal goal) {
+	const std::atomic<bool> cancelled = false;
+	const auto begin = std::chrono::steady_clock::now();
+	const std::optional<SolutionCounter::Result> result = SolutionCounter(limit, moveSet, goal).count(
+		start, true, cancelled);
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
 
-			auto nextMoves = moves;
-			nextMoves.push_back(Puzzle::encodeMove(MOVES[a], MOVES[b]));
-			checkSolved(bottomNext, nextMoves, false);
-			bottomNext.slice();
-			checkSolved(bottomNext, nextMoves, true);
-			solve(bottomNext, nextMoves, depth + 1);
-		}
+	if (!result) {
+		std::cout << "No solution found within " << limit << " moves.\n";
+		return 0;
 	}
+	std::cout << result->solutions << " solutions of " << result->length << " moves (" << elapsed.count() << "s)\n";
+	return 0;
 }
 
-void solveMultithread(const Puzzle &start, const std::vector<int_fast32_t> &baseMoves) {
-	std::vector<std::future<void> > futures;
+/**
+ * @brief Finds a cheapest solution of a state under a cost model, printing its cost and length. See Cost.h
+ */
+int solveCost(const Puzzle &start, const CostModel &model, const int limit, const MoveSet moveSet, const Goal goal) {
+	const std::atomic<bool> cancelled = false;
+	const auto begin = std::chrono::steady_clock::now();
+	const std::optional<CostSearch::Result> result = CostSearch(model, limit, moveSet, goal).solve(start, cancelled);
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
 
-	for (int_fast32_t a = 0; a < SIZE_OF_MOVES; ++a) {
-		Puzzle topNext = start.clone();
-		topNext.turn(MOVES[a], 0);
+	if (!result) {
+		std::cout << "No solution found within " << limit << " moves.\n";
+		return 0;
+	}
+	// Not simplified, which would merge a slice alone with the turns either side of it into a dearer move
+	std::vector<int_fast32_t> moves;
+	for (const Move move: result->moves) {
+		moves.push_back(move.encode());
+	}
+	std::cout << "Solution costing " << result->cost << " found in " << moves.size() << " moves ("
+			<< elapsed.count() << "s):\n" << formatScramble(moves, result->endsOnSlice) << '\n';
+	return 0;
+}
 
-		if (!topNext.canSliceTop()) {
-			continue;
-		}
+/**
+ * @brief Collects the most common sub-sequences of a file of solutions into a macro file. See Macro.h
+ */
+int learnMacros(const std::string &solutionsPath, const std::string &macrosPath, const std::size_t length,
+                const std::size_t count) {
+	std::ifstream in(solutionsPath);
+	if (!in) {
+		throw std::runtime_error("Cannot read " + solutionsPath);
+	}
+	const MacroTable macros = MacroTable::learn(in, length, count);
+	std::ofstream out(macrosPath);
+	if (!out) {
+		throw std::runtime_error("Cannot write " + macrosPath);
+	}
+	macros.write(out);
+	std::cerr << macros.size() << " macros written\n";
+	return 0;
+}
+
+/**
+ * @brief Solves a state by iterative deepening over steps, each a single move or a macro from a file. See Macro.h
+ */
+int solveMacros(const Puzzle &start, const std::string &macrosPath, const int steps, const int limit,
+                const MoveSet moveSet, const Goal goal) {
+	std::ifstream in(macrosPath);
+	if (!in) {
+		throw std::runtime_error("Cannot read " + macrosPath);
+	}
+	const MacroTable macros = MacroTable::read(in);
+	const std::atomic<bool> cancelled = false;
 
-		futures.emplace_back(std::async(std::launch::async, [topNext, a, baseMoves]() {
-			for (int_fast32_t b = 0; b < SIZE_OF_MOVES; ++b) {
-				Puzzle bottomNext = topNext.clone();
-				bottomNext.turn(0, MOVES[b]);
+	const auto begin = std::chrono::steady_clock::now();
+	const std::optional<MacroSearch::Result> result = MacroSearch(macros, steps, limit, moveSet, goal).solve(
+		start, cancelled);
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
 
-				if (!bottomNext.canSliceBottom()) {
-					continue;
-				}
+	if (!result) {
+		std::cout << "No solution found within " << steps << " steps and " << limit << " moves.\n";
+		return 0;
+	}
+	Simplifier simplifier;
+	simplifier.append(result->moves.data(), result->moves.data() + result->moves.size(), result->endsOnSlice);
+	std::cout << "Solution found in " << simplifier.size() << " moves (" << elapsed.count() << "s):\n"
+			<< simplifier.format() << '\n';
+	return 0;
+}
+
+/**
+ * @brief Follows a puzzle as it changes, reading turns and slices in solution notation from standard input,
+ * and prints the solution kept after each line and how long it took to update. See Session.h
+ *
+ * Each line ends with SolverSession::optimize(), so the solution printed is a shortest one within the move set
+ * unless it is marked otherwise. A line that fails is reported, keeping the changes before the one it failed on.
+ */
+int track(const Puzzle &start, const int limit, const MoveSet moveSet, const Goal goal) {
+	SolverSession session(start, limit, moveSet, goal);
+	const auto print = [&session](const double seconds) {
+		if (!session.hasSolution()) {
+			std::cout << "none\n";
+			return;
+		}
+		Simplifier simplifier;
+		simplifier.append(session.solution().data(), session.solution().data() + session.solution().size(),
+		                  session.endsOnSlice());
+		std::cout << simplifier.size() << (session.isOptimal() ? "\t" : "+\t") << simplifier.format() << "\t"
+				<< seconds * 1e6 << "us\n";
+	};
+	print(0);
 
-				auto nextMoves = baseMoves;
-				nextMoves.push_back(Puzzle::encodeMove(MOVES[a], MOVES[b]));
-				checkSolved(bottomNext, nextMoves, false);
-				bottomNext.slice();
-				checkSolved(bottomNext, nextMoves, true);
-				solve(bottomNext, nextMoves, 1);
+	std::string line;
+	while (std::getline(std::cin, line)) {
+		const auto begin = std::chrono::steady_clock::now();
+		// A line that doesn't parse, or slices where a corner is in the way, stops at the change it failed on
+		try {
+			bool endsOnSlice = true;
+			const std::vector<Move> moves = parseMoves(line, endsOnSlice);
+			for (std::size_t i = 0; i < moves.size(); ++i) {
+				if (i + 1 < moves.size() || endsOnSlice) {
+					session.move(moves[i].top, moves[i].bottom);
+				} else {
+					session.turn(moves[i].top, moves[i].bottom);
+				}
 			}
-		}));
+		} catch (const std::logic_error &e) {
+			std::cerr << e.what() << '\n';
+		}
+		session.optimize();
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+		print(elapsed.count());
 	}
+	std::cerr << session.searches() << " searches\n";
+	return 0;
+}
 
-	for (auto &fut: futures) {
-		fut.get();
+/**
+ * @brief Follows random move sequences from random states with a piece index, comparing it after every turn and
+ * slice with one built afresh from the puzzle. See PieceIndex.h
+ *
+ * @return 0 if the index always matched, 1 at the first mismatch.
+ */
+int checkIndex(const uint64_t sequences, const int length, const uint64_t seed) {
+	RandomState states(seed);
+	std::mt19937_64 random(seed);
+	uint64_t changes = 0;
+	for (uint64_t i = 0; i < sequences; ++i) {
+		const Puzzle start = states.next();
+		Puzzle puzzle = start;
+		PieceIndex index(puzzle);
+		for (int step = 0; step < length; ++step) {
+			const int top = static_cast<int>(random() % Puzzle::SLOTS_PER_ROW);
+			const int bottom = static_cast<int>(random() % Puzzle::SLOTS_PER_ROW);
+			puzzle.turn(top, bottom);
+			index.turn(top, bottom);
+			++changes;
+			bool matches = index == PieceIndex(puzzle);
+			// Most turns block the slice, so every one that doesn't is taken
+			if (matches && puzzle.canSlice()) {
+				puzzle.slice();
+				index.slice();
+				++changes;
+				matches = index == PieceIndex(puzzle);
+			}
+			if (!matches) {
+				std::cout << "Mismatch " << step + 1 << " moves from " << formatState(start) << '\n';
+				return 1;
+			}
+		}
 	}
+	std::cout << changes << " changes checked over " << sequences << " sequences\n";
+	return 0;
 }
 
-int main() {
+int solveDefault() {
 	Puzzle start;
-
 	std::vector<int_fast32_t> baseMoves = {};
-	start.move(baseMoves, 0, 0);
-	start.move(baseMoves, 3, 0);
-	start.move(baseMoves, -3, -3);
-	start.move(baseMoves, 0, 3);
-	start.move(baseMoves, 1, 0);
-	start.move(baseMoves, 0, 0);
-	start.move(baseMoves, 0, 0);
-	start.move(baseMoves, 0, 0);
-	start.move(baseMoves, 0, 0);
-	start.move(baseMoves, 3, 0);
-	start.move(baseMoves, -3, -3);
-	start.move(baseMoves, 0, 3);
+	defaultScramble(start, baseMoves);
 
-	solveMultithread(start, baseMoves);
+	Solver<>::Path solution;
+	bool solutionEndsOnSlice = false;
+	Solver solver([&](const Solver<>::Path &path, const bool endsOnSlice) {
+		solution = path;
+		solutionEndsOnSlice = endsOnSlice;
+		return true;
+	});
 
-	std::cout << "No solution found.\n";
+	if (!solver.solveMultithread(start)) {
+		std::cout << "No solution found.\n";
+		return 0;
+	}
+	printSolution(baseMoves, solution, solutionEndsOnSlice);
 	return 0;
 }
+
+int run(const int argc, char *argv[]) {
+	const std::string command = argc > 1 ? argv[1] : "";
+
+	if (command.empty()) {
+		return solveDefault();
+	}
+
+	if (command == "batch" && argc > 2) {
+		return solveBatch(argv[2], argc > 3 ? std::stoi(argv[3]) : Solver<>::DEFAULT_MAX_DEPTH,
+		                  argc > 4 ? parseMoveSet(argv[4]) : MoveSet::DEFAULT,
+		                  argc > 5 && std::string(argv[5]) == "--best-first");
+	}
+
+	if (command == "convert" && argc > 3) {
+		std::ifstream in(argv[2]);
+		if (!in) {
+			throw std::runtime_error("Cannot read " + std::string(argv[2]));
+		}
+		std::cerr << convertBatch(in, argv[3]) << " states written\n";
+		return 0;
+	}
+
+	if (command == "bench") {
+		return benchmark(argc > 2 ? std::stoi(argv[2]) : 4);
+	}
+
+	if (command == "count" && argc > 2) {
+		return countSolutions(parsePuzzle(argv[2]), argc > 3 ? std::stoi(argv[3]) : Solver<>::DEFAULT_MAX_DEPTH,
+		                      argc > 4 ? parseMoveSet(argv[4]) : MoveSet::DEFAULT,
+		                      parseGoal(argc > 5 ? argv[5] : "separated"));
+	}
+
+	if (command == "cost" && argc > 3) {
+		return solveCost(parsePuzzle(argv[2]), parseCostModel(argv[3]),
+		                 argc > 4 ? std::stoi(argv[4]) : Solver<>::DEFAULT_MAX_DEPTH,
+		                 argc > 5 ? parseMoveSet(argv[5]) : MoveSet::DEFAULT, parseGoal(argc > 6 ? argv[6] : "separated"));
+	}
+
+	if (command == "index" && argc > 2) {
+		return checkIndex(std::stoull(argv[2]), argc > 3 ? std::stoi(argv[3]) : 100,
+		                  argc > 4 ? std::stoull(argv[4]) : 0);
+	}
+
+	if (command == "learn" && argc > 3) {
+		return learnMacros(argv[2], argv[3], argc > 4 ? std::stoull(argv[4]) : 3, argc > 5 ? std::stoull(argv[5]) : 32);
+	}
+
+	if (command == "macro" && argc > 3) {
+		return solveMacros(parsePuzzle(argv[2]), argv[3], argc > 4 ? std::stoi(argv[4]) : 6,
+		                   argc > 5 ? std::stoi(argv[5]) : 16, argc > 6 ? parseMoveSet(argv[6]) : MoveSet::DEFAULT,
+		                   parseGoal(argc > 7 ? argv[7] : "separated"));
+	}
+
+	if (command == "perft" && argc > 2) {
+		const std::string mode = argc > 3 ? argv[3] : "";
+		const bool symmetric = mode == "--classes";
+		const bool distinct = symmetric || mode == "--distinct";
+		const int stateArg = distinct ? 4 : 3;
+		return perft(std::stoi(argv[2]), distinct, symmetric, argc > stateArg ? parsePuzzle(argv[stateArg]) : Puzzle());
+	}
+
+	if (command == "enumerate" && argc > 2) {
+		const std::optional<Puzzle> state = argc > 3 ? std::optional(parsePuzzle(argv[3])) : std::nullopt;
+		return enumerate(std::stoi(argv[2]), state ? &*state : nullptr,
+		                 argc > 4 ? parseMoveSet(argv[4]) : MoveSet::DEFAULT,
+		                 argc > 5 ? std::optional<std::size_t>(std::stoull(argv[5])) : std::nullopt);
+	}
+
+	if (command == "solve" && argc > 2) {
+		return solveState(parsePuzzle(argv[2]), argc > 3 ? std::stoi(argv[3]) : Solver<>::DEFAULT_MAX_DEPTH,
+		                  argc > 4 ? parseMoveSet(argv[4]) : MoveSet::DEFAULT, argc > 5 ? argv[5] : "");
+	}
+
+	if (command == "race" && argc > 2) {
+		return race(parsePuzzle(argv[2]), argc > 3 ? std::stoi(argv[3]) : Solver<>::DEFAULT_MAX_DEPTH,
+		            argc > 4 ? parseMoveSet(argv[4]) : MoveSet::DEFAULT, parseGoal(argc > 5 ? argv[5] : "separated"));
+	}
+
+	if (command == "random" && argc > 2) {
+		const bool scrambles = std::string(argv[argc - 1]) == "--scrambles";
+		const int seedArg = scrambles ? argc - 1 : argc;
+		return randomStates(std::stoull(argv[2]), seedArg > 3 ? std::stoull(argv[3]) : 0, scrambles);
+	}
+
+	if (command == "sample" && argc > 2) {
+		return sample(std::stoull(argv[2]), argc > 3 ? std::stoull(argv[3]) : 0, argc > 4 ? std::stoi(argv[4]) : 8);
+	}
+
+	if (command == "track" && argc > 2) {
+		return track(parsePuzzle(argv[2]), argc > 3 ? std::stoi(argv[3]) : Solver<>::DEFAULT_MAX_DEPTH,
+		             argc > 4 ? parseMoveSet(argv[4]) : MoveSet::DEFAULT, parseGoal(argc > 5 ? argv[5] : "separated"));
+	}
+
+	std::cerr << "Usage: " << argv[0] << " [batch <file> [limit] [moves] [--best-first] | bench [depth] | convert <text> <file>"
+			<< " | cost <state> <model> [limit] [moves] [goal] | count <state> [limit] [moves] [goal]"
+			<< " | enumerate <depth> [state] [moves] [count] | index <sequences> [length] [seed] | learn <solutions> <macros> [length] [count]"
+			<< " | macro <state> <macros> [steps] [limit] [moves] [goal] | perft <depth> [--distinct | --classes] [state] | race <state> [limit] [moves] [goal]"
+			<< " | random <count> [seed] [--scrambles]"
+			<< " | sample <count> [seed] [limit] | solve <state> [limit] [moves] [target | top | bottom]"
+			<< " | track <state> [limit] [moves] [goal]]\n";
+	return 1;
+}
+
+int main(const int argc, char *argv[]) {
+	try {
+		return run(argc, argv);
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << '\n';
+		return 1;
+	}
+}